@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+ * @file activity_gate.hpp
+ * @brief Hardware activity gating of the DSP stages (build option IMU_ACTIVITY_GATING).
+ *
+ * The LSM6DSL's embedded inactivity detector decides when the wearer is still
+ * (accel slope below the wake-up threshold for the sleep duration). In its
+ * sleep state the sensor drops the accelerometer to 12.5 Hz on its own, so
+ * imu_task wakes far less often. imu_task mirrors the sensor state into this
+ * gate:
+ *
+ * - closed: imu_task publishes no samples, fft_task and analysis_task block
+ *   on the gate and the status word reads NONE;
+ * - open: normal operation. Opening bumps an epoch that restarts the FFT
+ *   windows, and spectra resume after FFT_SMALL_SIZE samples.
+ */
+
+#include <stdint.h>
+
+#if defined(IMU_ACTIVITY_GATING) && (defined(PIPELINE_SINGLE_THREAD) || defined(PIPELINE_COROUTINES) || defined(IMU_FIFO_MODE) || defined(IMU_ADAPTIVE_ODR))
+#error "IMU_ACTIVITY_GATING is only supported by the threaded data-ready build"
+#endif
+
+/**
+ * @name Sensor configuration
+ * @{
+ */
+#define ACTIVITY_GATE_WAKE_THS      2   /**< WAKE_UP_THS, 1 LSB = FS/64 (~31 mg at 2 g). */
+#define ACTIVITY_GATE_SLEEP_DUR     1   /**< WAKE_UP_DUR sleep duration, 1 LSB = 512/ODR (~2.5 s). */
+#define ACTIVITY_GATE_POLL_US       100000  /**< Read the sensor sleep state this often while open (10 Hz). */
+/** @} */
+
+/**
+ * @name Waiter bits (one per blocked task)
+ * @{
+ */
+#define ACTIVITY_GATE_WAITER_FFT        (1u << 0)
+#define ACTIVITY_GATE_WAITER_ANALYSIS   (1u << 1)
+/** @} */
+
+/**
+ * @brief Suspend the DSP stages (imu_task, on sensor sleep).
+ */
+void activity_gate_close();
+
+/**
+ * @brief Resume the DSP stages (imu_task, on sensor wake-up).
+ */
+void activity_gate_open();
+
+/**
+ * @brief Check whether the DSP stages may run.
+ */
+bool activity_gate_is_open();
+
+/**
+ * @brief Block the calling task until the gate is open.
+ * @param waiter ACTIVITY_GATE_WAITER_* bit of the caller.
+ */
+void activity_gate_wait_open(uint32_t waiter);
+
+/**
+ * @brief What imu_task does with a data-ready edge after activity_gate_step().
+ */
+typedef enum {
+    ACTIVITY_GATE_EDGE_PUBLISH = 0, /**< Gate open: read and publish the sample. */
+    ACTIVITY_GATE_EDGE_CONSUMED,    /**< Gate closed, or closed on this edge: publish nothing. */
+    ACTIVITY_GATE_EDGE_OPENED,      /**< Gate opened on this edge: restart edge timing, publish from the next edge. */
+} activity_gate_edge_t;
+
+/**
+ * @brief Mirror the sensor's sleep state into the gate on one data-ready edge.
+ *
+ * While open, the sleep flag is read once ACTIVITY_GATE_POLL_US has passed
+ * since the last poll; the time comes from the edge timestamps, so the drop
+ * to the 12.5 Hz sleep rate does not stretch the interval. While closed, the
+ * edges come from the sleep rate and each one only checks for the wake-up.
+ * If the bus is busy with an asynchronous read or the state read fails, the
+ * gate keeps its state until the next poll.
+ *
+ * @param edge_us Data-ready edge time (imu_data_ready_time_us()).
+ */
+activity_gate_edge_t activity_gate_step(uint32_t edge_us);
+
+/**
+ * @brief Number of times the gate opened; changes whenever the windows must restart.
+ */
+uint32_t activity_gate_epoch();
+
+/**
+ * @brief Gating statistics over one report period.
+ */
+typedef struct {
+    bool open;              /**< Gate state at the end of the period. */
+    uint32_t period_ms;     /**< Length of the period. */
+    uint32_t gated_ms;      /**< Time the DSP was gated off. */
+    uint32_t gated_pct;     /**< gated_ms as a percentage of period_ms. */
+    uint32_t closures;      /**< Times the gate closed. */
+} activity_gate_stats_t;
+
+/**
+ * @brief Get the gating statistics since the last call and start a new period.
+ * @param stats Output statistics.
+ */
+void activity_gate_get_and_reset(activity_gate_stats_t *stats);
+
+/**
+ * @brief Log the fraction of time the DSP was gated off since the last call.
+ */
+void activity_gate_report();
@@ -0,0 +1,90 @@
+#pragma once
+
+/**
+ * @file adaptive_odr.hpp
+ * @brief Motion-adaptive IMU output data rate (build option IMU_ADAPTIVE_ODR).
+ *
+ * While the wearer is at rest the detectors have nothing to find, so the
+ * sensor is slowed to ADAPTIVE_ODR_REST_HZ and the spectral and analysis work
+ * is suspended:
+ *
+ *   ACTIVE --(quiet spectra)--> REST_PENDING --(imu_task)--> REST
+ *   REST --(motion in a low-rate sample)--> ACTIVE
+ *
+ * The analysis task votes for rest from the gyro band power; imu_task owns the
+ * bus and performs both rate switches. In REST imu_task only checks each
+ * low-rate sample against the wake thresholds and publishes nothing. Waking
+ * bumps an epoch that makes fft_task restart its windows, so no spectrum ever
+ * mixes samples from before and after the pause.
+ */
+
+#include <stdint.h>
+#include "arm_math.h"
+
+#if defined(IMU_ADAPTIVE_ODR) && (defined(PIPELINE_SINGLE_THREAD) || defined(PIPELINE_COROUTINES) || defined(IMU_FIFO_MODE))
+#error "IMU_ADAPTIVE_ODR is only supported by the threaded data-ready build"
+#endif
+
+/**
+ * @name Thresholds
+ * @{
+ */
+#define ADAPTIVE_ODR_REST_HZ        26      /**< Sensor rate while resting. */
+#define ADAPTIVE_ODR_REST_POWER     0.02f   /**< Gyro PSD power 0.5-12 Hz (max over axes) of a quiet frame. */
+#define ADAPTIVE_ODR_REST_FRAMES    30      /**< Consecutive quiet frames before slowing down (~3 s). */
+#define ADAPTIVE_ODR_WAKE_GYRO      0.2f    /**< Angular rate on any axis that wakes (rad/s). */
+#define ADAPTIVE_ODR_WAKE_ACCEL     0.05f   /**< Accel change between rest samples on any axis that wakes (g). */
+/** @} */
+
+/**
+ * @brief Rate states.
+ */
+typedef enum {
+    ADAPTIVE_ODR_ACTIVE = 0,    /**< Full rate, full pipeline. */
+    ADAPTIVE_ODR_REST_PENDING,  /**< Rest requested, imu_task has not switched yet. */
+    ADAPTIVE_ODR_REST           /**< Low rate, pipeline idle. */
+} adaptive_odr_state_t;
+
+/**
+ * @brief Feed one analyzed spectrum (analysis task).
+ *
+ * Frames with the same `frame_time_us` as the previous one are stale and
+ * ignored, so re-reading an old result never counts towards rest.
+ *
+ * @param band_power Gyro power 0.5-12 Hz (max over axes).
+ * @param frame_time_us Data-ready time of the newest sample in the window.
+ */
+void adaptive_odr_frame(float32_t band_power, uint32_t frame_time_us);
+
+/**
+ * @brief Get the current rate state.
+ */
+adaptive_odr_state_t adaptive_odr_get_state();
+
+/**
+ * @brief Record that the sensor now runs at ADAPTIVE_ODR_REST_HZ (imu_task).
+ */
+void adaptive_odr_enter_rest();
+
+/**
+ * @brief Check a low-rate sample against the wake thresholds (imu_task).
+ * @param accel Accel sample (g).
+ * @param gyro Gyro sample (rad/s).
+ * @return true if the wearer moved.
+ */
+bool adaptive_odr_check_motion(const float32_t *accel, const float32_t *gyro);
+
+/**
+ * @brief Record that the sensor is back at full rate (imu_task).
+ */
+void adaptive_odr_wake();
+
+/**
+ * @brief Number of wakeups so far; changes whenever the windows must restart.
+ */
+uint32_t adaptive_odr_epoch();
+
+/**
+ * @brief Log time spent resting and wakeups since the last call.
+ */
+void adaptive_odr_report();
@@ -15,17 +15,75 @@
 // LSM6DSL I2C address (0x6A shifted left by 1 for Mbed's 8-bit addressing)
 #define LSM6DSL_ADDR        (0x6A << 1)
 // Register addresses
+#define FIFO_CTRL1          0x06  // FIFO watermark threshold [7:0]
+#define FIFO_CTRL2          0x07  // FIFO watermark threshold [10:8]
+#define FIFO_CTRL3          0x08  // FIFO gyro/accel decimation
+#define FIFO_CTRL4          0x09  // FIFO third/fourth data set decimation
+#define FIFO_CTRL5          0x0A  // FIFO ODR and mode
 #define WHO_AM_I            0x0F  // Device identification register
 #define CTRL1_XL            0x10  // Accelerometer control register
 #define CTRL2_G             0x11  // Gyroscope control register
 #define CTRL3_C             0x12  // Common control register
 #define DRDY_PULSE_CFG      0x0B  // Data-ready pulse configuration
 #define INT1_CTRL           0x0D  // INT1 pin routing control
+#define WAKE_UP_SRC         0x1B  // Wake-up / sleep state source
 #define STATUS_REG          0x1E  // Status register (data ready flags)
 #define OUTX_L_G            0x22  // Gyroscope X-axis low byte start address
 #define OUTX_L_XL           0x28  // Accelerometer X-axis low byte start address
+#define OUTZ_H_XL           0x2D  // Accelerometer Z-axis high byte (end of output block)
+#define FIFO_STATUS1        0x3A  // FIFO level [7:0] (16-bit words)
+#define FIFO_STATUS2        0x3B  // FIFO flags and level [10:8]
+#define FIFO_STATUS3        0x3C  // FIFO pattern [7:0]
+#define FIFO_STATUS4        0x3D  // FIFO pattern [9:8]
+#define FIFO_DATA_OUT_L     0x3E  // FIFO data output (low byte)
+#define TAP_CFG             0x58  // Interrupt enable, inactivity mode
+#define WAKE_UP_THS         0x5B  // Wake-up threshold
+#define WAKE_UP_DUR         0x5C  // Wake-up and sleep durations
 /** @} */
 
+/**
+ * @name Output data rate (CTRL1_XL / CTRL2_G, full scale 2 g / 250 dps)
+ * @{
+ */
+#define CTRL_ODR_26HZ       0x20
+#define CTRL_ODR_208HZ      0x50
+/** @} */
+
+/**
+ * @name FIFO configuration
+ * @{
+ */
+// CTRL5: ODR_FIFO = 208 Hz (0101), FIFO_MODE = continuous (110).
+#define FIFO_CTRL5_208HZ_CONTINUOUS 0x2E
+// CTRL3: no decimation for gyro and accel (both in FIFO).
+#define FIFO_CTRL3_NO_DECIMATION    0x09
+#define FIFO_STATUS2_OVER_RUN       0x40
+#define INT1_CTRL_DRDY_XL           0x01
+#define INT1_CTRL_FTH               0x08
+// Words per FIFO sample: gyro x/y/z then accel x/y/z.
+#define IMU_FIFO_WORDS_PER_SAMPLE   6
+#define IMU_FIFO_WATERMARK_SAMPLES  52      /**< ~250 ms at 208 Hz (4 wakeups/s). */
+#define IMU_FIFO_READ_CHUNK         16      /**< Samples per burst read. */
+/** @} */
+
+/**
+ * @name Activity / inactivity configuration
+ * @{
+ */
+// TAP_CFG: INTERRUPTS_ENABLE, INACT_EN = 01 (accel to 12.5 Hz in sleep, gyro unchanged).
+#define TAP_CFG_INACT_XL_12HZ5      0xA0
+#define WAKE_UP_SRC_SLEEP_STATE     0x10
+/** @} */
+
+/**
+ * @brief Length of the gyro + accel output block (OUTX_L_G..OUTZ_H_XL).
+ *
+ * With IF_INC set in CTRL3_C the whole block is read in one transaction:
+ * register address + 12 data bytes, instead of 12 separate address/data
+ * round trips for the same six values.
+ */
+#define IMU_BURST_LEN       (OUTZ_H_XL - OUTX_L_G + 1)
+
 /**
  * @brief INT1 interrupt pin used for data-ready.
  */
@@ -40,27 +98,142 @@
 #define GYRO_SENSITIVITY    0.00875f
 /** @} */
 
+/**
+ * @name Raw sample layout (gyro x/y/z, then accel x/y/z, as in the output block)
+ * @{
+ */
+#define IMU_RAW_GYRO        0
+#define IMU_RAW_ACCEL       3
+#define IMU_RAW_WORDS       6
+/** @} */
+
+/**
+ * @name Physical units per LSB (float-only)
+ * @{
+ */
+#define IMU_ACC_SCALE       ACC_SENSITIVITY
+#define IMU_GYRO_SCALE      (GYRO_SENSITIVITY * NUMERIC_DEG_TO_RAD)  /**< deg/s -> rad/s */
+/** @} */
+
 /**
  * @brief IMU sample rate configured in the sensor (Hz).
  */
 #define IMU_SAMPLE_RATE_HZ 208
 
 #include <time.h>
+#include "mbed.h"
 #include "arm_math.h"
+#include "numeric.hpp"
 
 /**
- * @brief Read accelerometer data (3 axes).
+ * @brief Read raw gyro and accel values with one burst transaction.
+ * @param raw Output array of 6 values: gyro x/y/z, then accel x/y/z.
+ * @return true on success, false on I2C failure.
+ */
+bool imu_read_raw(int16_t* raw);
+
+/**
+ * @brief Read and scale gyro and accel data with one burst transaction.
+ *
+ * Raw values are converted with one multiply per axis by the float unit
+ * scales (IMU_GYRO_SCALE, IMU_ACC_SCALE).
+ *
  * @param acc Output array of length 3 (units depend on ACC_SENSITIVITY).
+ * @param gyro Output array of length 3, in rad/s.
  * @return true on success, false on I2C failure.
  */
-bool imu_read_acc_data(float32_t* acc);
+bool imu_read_data(float32_t* acc, float32_t* gyro);
+
+#if DEVICE_I2C_ASYNCH
+/**
+ * @brief Start a non-blocking burst read of the gyro + accel output block.
+ *
+ * The transfer runs under interrupt control (I2C::transfer), so the calling
+ * thread returns immediately and the CPU is free during bus time. `done` is
+ * called from interrupt context when the transfer finishes; `raw` must stay
+ * valid until then.
+ *
+ * @param raw Output array of 6 values: gyro x/y/z, then accel x/y/z.
+ * @param done Completion handler, called with true on success (ISR-safe only).
+ * @return true if the transfer was started, false if the bus is busy.
+ */
+bool imu_read_raw_async(int16_t* raw, Callback<void(bool)> done);
+
+/**
+ * @brief Check whether an asynchronous read is still in flight.
+ */
+bool imu_read_async_busy();
+#endif
 
 /**
- * @brief Read gyroscope data (3 axes).
+ * @brief Convert one raw sample (gyro x/y/z, accel x/y/z) to physical units.
+ * @param raw Raw values as returned by imu_read_raw() or the FIFO.
+ * @param acc Output array of length 3 (units depend on ACC_SENSITIVITY).
  * @param gyro Output array of length 3, in rad/s.
+ */
+void imu_convert_raw(const int16_t* raw, float32_t* acc, float32_t* gyro);
+
+/**
+ * @brief Switch the sensor to FIFO mode with a watermark interrupt on INT1.
+ *
+ * Gyro and accel are stored in the on-chip FIFO at IMU_SAMPLE_RATE_HZ in
+ * continuous mode, and INT1 is routed to the watermark flag instead of
+ * data-ready.
+ *
+ * @param watermark_samples Samples (gyro + accel sets) that raise INT1.
+ * @return true on success, false on I2C failure.
+ */
+bool imu_fifo_enable(uint16_t watermark_samples);
+
+/**
+ * @brief Get the number of complete samples waiting in the FIFO.
+ *
+ * Realigns the read pointer to a gyro X word if a previous overrun left it in
+ * the middle of a sample.
+ *
+ * @param overrun Output: true if the FIFO overflowed and data was lost.
+ * @return Number of complete samples, or -1 on I2C failure.
+ */
+int imu_fifo_level(bool *overrun);
+
+/**
+ * @brief Burst-read samples from the FIFO.
+ * @param raw Output array of `count` samples (gyro x/y/z, accel x/y/z).
+ * @param count Number of samples (must not exceed imu_fifo_level()).
+ * @return true on success, false on I2C failure.
+ */
+bool imu_fifo_read(int16_t (*raw)[IMU_FIFO_WORDS_PER_SAMPLE], int count);
+
+/**
+ * @brief Change the accel and gyro output data rate.
+ *
+ * Must not be called while an asynchronous read is in flight.
+ *
+ * @param ctrl_odr CTRL_ODR_* value written to CTRL1_XL and CTRL2_G.
  * @return true on success, false on I2C failure.
  */
-bool imu_read_gyro_data(float32_t* gyro);
+bool imu_set_odr(uint8_t ctrl_odr);
+
+/**
+ * @brief Enable the embedded activity / inactivity detector.
+ *
+ * The sensor enters its sleep state when the accel slope stays below
+ * `wake_ths` for `sleep_dur`, lowering the accel rate (and with it the
+ * data-ready interrupt) to 12.5 Hz, and leaves it on the first sample above
+ * the threshold.
+ *
+ * @param wake_ths Wake-up threshold (WAKE_UP_THS, 1 LSB = full scale / 64).
+ * @param sleep_dur Sleep duration (WAKE_UP_DUR, 1 LSB = 512 / ODR).
+ * @return true on success, false on I2C failure.
+ */
+bool imu_activity_enable(uint8_t wake_ths, uint8_t sleep_dur);
+
+/**
+ * @brief Read the sleep state of the activity detector.
+ * @return 1 if the sensor is in its sleep (inactive) state, 0 if active,
+ *         -1 on I2C failure.
+ */
+int imu_activity_sleeping();
 
 /**
  * @brief Initialize the IMU (I2C, interrupt pin, and configuration registers).
@@ -85,3 +258,23 @@ bool imu_data_wait(time_t timeout);
  * @brief Clear the data-ready flag.
  */
 void imu_data_ready_clear();
+
+/**
+ * @brief Time of the most recent data-ready edge.
+ *
+ * Captured with the microsecond ticker inside the INT1 rise handler, so it is
+ * free of thread scheduling and RTOS tick jitter.
+ *
+ * @return us_ticker_read() value at the last edge (wraps every ~71 minutes).
+ */
+uint32_t imu_data_ready_time_us();
+
+/**
+ * @brief Attach an extra handler to the data-ready interrupt.
+ *
+ * The handler runs in interrupt context in addition to setting the data-ready
+ * flag, so it must be ISR-safe (e.g. EventQueue::call()).
+ *
+ * @param cb Handler to invoke on every data-ready edge.
+ */
+void imu_data_ready_attach(Callback<void()> cb);
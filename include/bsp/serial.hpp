@@ -20,6 +20,13 @@ bool serial_init();
  */
 void serial_send(const char *data);
 
+/**
+ * @brief Read one received character without blocking.
+ * @param c Output: the character.
+ * @return true if a character was available.
+ */
+bool serial_read_char(char *c);
+
 /**
  * @brief Lock the serial output mutex.
  */
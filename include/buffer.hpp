@@ -11,6 +11,11 @@
  * length 2*window_size. This makes the last `window_size` samples always
  * available as one contiguous array, which is convenient for DSP routines
  * (e.g., FFT) without doing an extra copy or wrap-around handling.
+ *
+ * On a Linux host, src/host/buffer_host.cpp implements the same C API by
+ * mapping one memfd twice in a row instead: each element is written once and
+ * the ring (`capacity`, page-rounded, at least `window_size`) can be read as
+ * one contiguous block from any start index.
  */
 
 /**
@@ -23,7 +28,8 @@ typedef struct mirror_buffer_t {
     void *buffer;           /**< Backing storage (2 * window_size elements). */
     size_t window_size;     /**< Window length (number of elements). */
     size_t element_size;    /**< Size of one element in bytes. */
-    uint32_t write_index;   /**< Next write index (wraps 0..window_size-1). */
+    size_t capacity;        /**< Ring length in elements (window_size for the copying buffer). */
+    uint32_t write_index;   /**< Next write index (wraps 0..capacity-1). */
 } mirror_buffer_t;
 
 /**
@@ -34,6 +40,24 @@ typedef struct mirror_buffer_t {
  */
 mirror_buffer_t* mirror_buffer_create(size_t window_size, size_t element_size);
 
+/**
+ * @brief Initialize a mirror buffer on caller-provided (e.g. static) storage.
+ *
+ * Copying implementation only. Use MIRROR_BUFFER_STORAGE_BYTES() to size
+ * `storage`; do not pass a buffer initialized this way to mirror_buffer_destroy().
+ *
+ * @param mb Buffer handle to fill in.
+ * @param storage Backing storage of 2 * window_size elements.
+ * @param window_size Number of elements in the sliding window.
+ * @param element_size Size of one element in bytes.
+ */
+void mirror_buffer_init(mirror_buffer_t *mb, void *storage, size_t window_size, size_t element_size);
+
+/**
+ * @brief Bytes of backing storage mirror_buffer_init() needs.
+ */
+#define MIRROR_BUFFER_STORAGE_BYTES(window_size, element_size) (2 * (window_size) * (element_size))
+
 /**
  * @brief Destroy a mirror buffer and free its memory.
  * @param mb Buffer handle (can be NULL).
@@ -62,10 +86,240 @@ void* mirror_buffer_get_window(mirror_buffer_t *mb);
  *
  * Offset is relative to the current newest window:
  * - offset = 0: current window
- * - offset = 1: previous window (one full cycle ago)
+ * - offset = k: window ending k elements before the newest one
  *
  * @param mb Buffer handle.
- * @param offset Window offset in cycles.
+ * @param offset Window offset in elements (at most capacity - window_size).
  * @return Pointer to a contiguous array of `window_size` elements.
  */
 void* mirror_buffer_get_window_offset(mirror_buffer_t *mb, uint32_t offset);
+
+/**
+ * @brief Typed, fixed-capacity mirror buffer (static storage, no heap).
+ *
+ * Same layout as mirror_buffer_t (each element stored at i and i+N), but the
+ * element type and window length are compile-time constants: a push is two
+ * typed stores plus an index update, and when N is a power of two the
+ * wrap-around is a mask instead of a modulo.
+ *
+ * Only the newest window is contiguous: the storage holds exactly N samples,
+ * so there is no older window to point at. Use mirror_buffer_history for
+ * look-back.
+ *
+ * Zero-initialized when declared static; not thread-safe.
+ *
+ * @tparam T Element type (trivially copyable).
+ * @tparam N Window length (elements).
+ */
+template <typename T, size_t N>
+struct mirror_buffer {
+    static_assert(N > 0, "mirror_buffer needs a non-empty window");
+
+    T storage[2 * N];       /**< Backing storage (2 * N elements). */
+    uint32_t write_index;   /**< Next write index (wraps 0..N-1). */
+
+    /** @brief Whether wrap-around uses a mask (N is a power of two). */
+    static constexpr bool masked = (N & (N - 1)) == 0;
+
+    /** @brief Reduce an index to 0..N-1. */
+    static uint32_t wrap(uint32_t index) {
+        return masked ? (index & (uint32_t)(N - 1)) : (uint32_t)(index % N);
+    }
+
+    /** @brief Clear the storage and restart at index 0. */
+    void reset() {
+        for (size_t i = 0; i < 2 * N; i++) {
+            storage[i] = T();
+        }
+        write_index = 0;
+    }
+
+    /** @brief Push one element into the sliding window. */
+    void push(T value) {
+        storage[write_index] = value;
+        storage[write_index + N] = value;
+        write_index = wrap(write_index + 1);
+    }
+
+    /** @brief Contiguous window of N elements (oldest -> newest), valid until the next push. */
+    const T *window() const {
+        return &storage[write_index];
+    }
+};
+
+/**
+ * @brief Multi-channel mirror buffer: C windows of N elements, one write index.
+ *
+ * Structure-of-arrays layout: each channel is a mirror region of 2*N elements
+ * and the channels follow each other in one static block, so all C windows
+ * advance together. A push takes one element per channel (e.g. a whole raw
+ * IMU sample) and updates the index once.
+ *
+ * As with mirror_buffer, only the newest window of each channel is
+ * contiguous; mirror_buffer_history keeps older windows.
+ *
+ * Zero-initialized when declared static; not thread-safe.
+ *
+ * @tparam T Element type (trivially copyable).
+ * @tparam C Number of channels.
+ * @tparam N Window length per channel (elements).
+ */
+template <typename T, size_t C, size_t N>
+struct mirror_buffer_multi {
+    static_assert(C > 0 && N > 0, "mirror_buffer_multi needs channels and a non-empty window");
+
+    T storage[C][2 * N];    /**< One mirror region per channel. */
+    uint32_t write_index;   /**< Next write index shared by all channels (wraps 0..N-1). */
+
+    /** @brief Distance between two channel windows (elements). */
+    static constexpr size_t channel_stride = 2 * N;
+
+    /** @brief Reduce an index to 0..N-1 (a mask when N is a power of two). */
+    static uint32_t wrap(uint32_t index) {
+        return mirror_buffer<T, N>::wrap(index);
+    }
+
+    /** @brief Clear all channels and restart at index 0. */
+    void reset() {
+        for (size_t c = 0; c < C; c++) {
+            for (size_t i = 0; i < 2 * N; i++) {
+                storage[c][i] = T();
+            }
+        }
+        write_index = 0;
+    }
+
+    /**
+     * @brief Push one element into every channel.
+     * @param values C elements, one per channel in channel order.
+     */
+    void push(const T *values) {
+        uint32_t index = write_index;
+        for (size_t c = 0; c < C; c++) {
+            storage[c][index] = values[c];
+            storage[c][index + N] = values[c];
+        }
+        write_index = wrap(index + 1);
+    }
+
+    /** @brief Contiguous window of channel `c` (oldest -> newest), valid until the next push. */
+    const T *window(size_t c) const {
+        return &storage[c][write_index];
+    }
+};
+
+/**
+ * @brief Multi-channel sliding buffer that keeps H windows of history.
+ *
+ * Each channel is a ring of R = H*N elements followed by an N-element tail
+ * that mirrors the first N ring slots. Any window of N elements, wherever it
+ * starts in the ring, is therefore contiguous: the window ending k samples
+ * before the newest one is available without copying for k up to R - N
+ * ((H-1) full windows back), e.g. for trend features or pre-trigger capture.
+ * Only writes to the first N slots are stored twice, so a push costs C stores
+ * plus C more once every H windows, and RAM is C*(H+1)*N elements instead of
+ * 2*C*H*N for a plain mirror buffer of the same depth.
+ *
+ * The object is plain static storage and can be placed in a dedicated RAM
+ * section with MBED_SECTION(...). A section that startup code does not zero
+ * needs reset() before the first push.
+ *
+ * Not thread-safe.
+ *
+ * @tparam T Element type (trivially copyable).
+ * @tparam C Number of channels.
+ * @tparam N Window length (elements).
+ * @tparam H History depth in windows (ring length H*N).
+ */
+template <typename T, size_t C, size_t N, size_t H>
+struct mirror_buffer_history {
+    static_assert(C > 0 && N > 0 && H > 0, "mirror_buffer_history needs channels, a window and a depth");
+
+    /** @brief Ring length per channel (elements). */
+    static constexpr size_t ring_size = H * N;
+
+    T storage[C][ring_size + N];  /**< Ring plus mirrored tail, per channel. */
+    uint32_t write_index;         /**< Next write index shared by all channels (0..ring_size-1). */
+    uint32_t filled;              /**< Samples pushed since reset, saturating at ring_size. */
+
+    /** @brief Reduce an index to 0..ring_size-1 (a mask when ring_size is a power of two). */
+    static uint32_t wrap(uint32_t index) {
+        return mirror_buffer<T, ring_size>::wrap(index);
+    }
+
+    /** @brief Clear all channels and the history. */
+    void reset() {
+        for (size_t c = 0; c < C; c++) {
+            for (size_t i = 0; i < ring_size + N; i++) {
+                storage[c][i] = T();
+            }
+        }
+        write_index = 0;
+        filled = 0;
+    }
+
+    /**
+     * @brief Push one element into every channel.
+     * @param values C elements, one per channel in channel order.
+     */
+    void push(const T *values) {
+        uint32_t index = write_index;
+        for (size_t c = 0; c < C; c++) {
+            storage[c][index] = values[c];
+        }
+        if (index < N) {
+            for (size_t c = 0; c < C; c++) {
+                storage[c][index + ring_size] = values[c];
+            }
+        }
+        write_index = wrap(index + 1);
+        if (filled < ring_size) {
+            filled++;
+        }
+    }
+
+    /**
+     * @brief Whether the window ending `back` samples before the newest one holds
+     *        only pushed data and is still in the ring.
+     */
+    bool window_valid(uint32_t back) const {
+        return back <= ring_size - N && filled >= N + back;
+    }
+
+    /**
+     * @brief Contiguous window of channel `c` ending `back` samples before the newest.
+     * @param c Channel.
+     * @param back Samples between the window's last element and the newest sample.
+     * @return Pointer to N elements (oldest -> newest), or NULL if !window_valid(back).
+     *         Valid until the ring overwrites it ((H*N - N - back) more pushes).
+     */
+    const T *window_back(size_t c, uint32_t back) const {
+        if (!window_valid(back)) return NULL;
+        return &storage[c][wrap(write_index + (uint32_t)(ring_size - N) - back)];
+    }
+
+    /** @brief Newest window of channel `c` (NULL until N samples were pushed). */
+    const T *window(size_t c) const {
+        return window_back(c, 0);
+    }
+};
+
+#ifdef BUFFER_BENCH
+/**
+ * @brief Compare mirror_buffer_t and mirror_buffer<T, N> push/window costs.
+ *
+ * Runs once at start-up (build option BUFFER_BENCH) and logs DWT cycles per
+ * operation for the C buffer and the template, with an int16 element and
+ * FFT_BUFFER_SIZE window as used by fft_task.
+ */
+void buffer_bench_run();
+
+/**
+ * @brief RAM of the bench buffers: the C buffer's storage, the template
+ *        buffer, one template buffer per raw IMU word and the multi-channel
+ *        buffer (FFT_BUFFER_SIZE windows, from fft_task.hpp).
+ */
+#define BUFFER_BENCH_BYTES (MIRROR_BUFFER_STORAGE_BYTES(FFT_BUFFER_SIZE, sizeof(int16_t)) \
+    + (1 + IMU_RAW_WORDS) * sizeof(mirror_buffer<int16_t, FFT_BUFFER_SIZE>) \
+    + sizeof(mirror_buffer_multi<int16_t, IMU_RAW_WORDS, FFT_BUFFER_SIZE>))
+#endif
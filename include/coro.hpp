@@ -0,0 +1,156 @@
+#pragma once
+
+/**
+ * @file coro.hpp
+ * @brief Minimal stackless-coroutine executor for pipeline stages (C++20).
+ *
+ * Stages are written as ordinary loops that suspend with `co_await`:
+ *
+ *   coro::task led_stage() {
+ *       while (true) {
+ *           led_step();
+ *           co_await coro::sleep(50ms);
+ *       }
+ *   }
+ *
+ * All stages are resumed from a single thread by coro::run(), in the order they
+ * were spawned. A suspended stage only keeps its coroutine frame (allocated
+ * from a small static pool, typically a few tens of bytes), not a whole stack.
+ *
+ * This header and coro.cpp do not depend on Mbed. The target provides the
+ * three coro_platform_* hooks below, so the executor can also be built on a
+ * host with a different clock and wait primitive.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <chrono>
+#include <coroutine>
+
+/**
+ * @brief Maximum number of stages the executor can hold.
+ */
+#define CORO_MAX_STAGES 6
+
+/**
+ * @brief Size of the static pool that holds all coroutine frames (bytes).
+ */
+#define CORO_FRAME_POOL_SIZE 1024
+
+/**
+ * @name Executor events
+ * Events are raised with coro::notify() (ISR-safe) and wake every stage that
+ * waits on them.
+ * @{
+ */
+#define CORO_EVENT_SAMPLE (1u << 0)  /**< New IMU sample available. */
+#define CORO_EVENT_FRAME  (1u << 1)  /**< New FFT result published. */
+/** @} */
+
+/**
+ * @name Platform hooks (implemented by the target)
+ * @{
+ */
+/** @brief Monotonic time in milliseconds. */
+uint32_t coro_platform_now_ms();
+/** @brief Block up to `timeout_ms`, returning early after coro_platform_wake(). */
+void coro_platform_wait(uint32_t timeout_ms);
+/** @brief Wake a pending coro_platform_wait() (must be ISR-safe). */
+void coro_platform_wake();
+/** @} */
+
+namespace coro {
+
+/**
+ * @brief Coroutine return type for a pipeline stage.
+ *
+ * Stages start suspended and are first resumed by the executor. Frames come
+ * from the static frame pool; allocation failure yields an empty task.
+ */
+struct task {
+    struct promise_type {
+        task get_return_object() noexcept {
+            return task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        static task get_return_object_on_allocation_failure() noexcept {
+            return task{nullptr};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {}
+
+        static void *operator new(size_t size) noexcept;
+        static void operator delete(void *ptr, size_t size) noexcept;
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @brief Awaitable that suspends the current stage for a fixed time.
+ */
+struct sleep_awaiter {
+    uint32_t ms;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) noexcept;
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Awaitable that suspends the current stage until one of `events` is raised.
+ */
+struct event_awaiter {
+    uint32_t events;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) noexcept;
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Suspend the current stage for `duration`.
+ */
+template <typename Rep, typename Period>
+inline sleep_awaiter sleep(std::chrono::duration<Rep, Period> duration) {
+    return sleep_awaiter{(uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()};
+}
+
+/**
+ * @brief Suspend the current stage until the next IMU sample is signalled.
+ */
+inline event_awaiter next_sample() {
+    return event_awaiter{CORO_EVENT_SAMPLE};
+}
+
+/**
+ * @brief Suspend the current stage until the next FFT frame is signalled.
+ */
+inline event_awaiter next_frame() {
+    return event_awaiter{CORO_EVENT_FRAME};
+}
+
+/**
+ * @brief Register a stage. Stages are resumed in spawn order.
+ * @param t Task returned by calling the stage coroutine.
+ * @param name Stage name (for diagnostics).
+ * @return false if the frame could not be allocated or all slots are used.
+ */
+bool spawn(task t, const char *name);
+
+/**
+ * @brief Raise executor events (ISR-safe).
+ * @param events CORO_EVENT_* bits.
+ */
+void notify(uint32_t events);
+
+/**
+ * @brief Run all stages forever on the calling thread.
+ */
+void run();
+
+/**
+ * @brief Bytes of the frame pool used by spawned stages.
+ */
+size_t frame_pool_used();
+
+} // namespace coro
@@ -0,0 +1,75 @@
+#pragma once
+
+/**
+ * @file governor.hpp
+ * @brief CPU-load-adaptive quality governor for the spectral stage.
+ *
+ * The governor is fed once per diagnostics period with the CPU usage and the
+ * largest IMU mailbox backlog seen by fft_task. Under overload it degrades the
+ * spectral work one step at a time:
+ *
+ *   NORMAL -> LARGE_HOP -> SKIP_ACCEL -> SMALL_FFT
+ *
+ * Each level includes the degradations of the previous ones. A step is taken
+ * back only after the load stayed low for GOVERNOR_RELAX_PERIODS consecutive
+ * updates (hysteresis). Every transition is logged.
+ */
+
+#include <stdint.h>
+
+/**
+ * @name Thresholds
+ * @{
+ */
+#define GOVERNOR_HIGH_LOAD_PCT   85  /**< Escalate above this CPU usage. */
+#define GOVERNOR_LOW_LOAD_PCT    60  /**< Relax below this CPU usage. */
+#define GOVERNOR_HIGH_BACKLOG    5   /**< Escalate when this many samples queue up. */
+#define GOVERNOR_LOW_BACKLOG     1   /**< Relax only while backlog stays at or below this. */
+#define GOVERNOR_RELAX_PERIODS   3   /**< Consecutive calm updates before relaxing. */
+/** @} */
+
+/**
+ * @name Degraded settings
+ * @{
+ */
+#define GOVERNOR_NORMAL_HOP      1   /**< Samples between spectra at NORMAL. */
+#define GOVERNOR_LARGE_HOP       8   /**< Samples between spectra from LARGE_HOP on. */
+/** @} */
+
+/**
+ * @brief Degradation levels (each includes the previous ones).
+ */
+typedef enum {
+    GOVERNOR_LEVEL_NORMAL = 0,  /**< Full quality. */
+    GOVERNOR_LEVEL_LARGE_HOP,   /**< Compute spectra every GOVERNOR_LARGE_HOP samples. */
+    GOVERNOR_LEVEL_SKIP_ACCEL,  /**< Skip accelerometer spectra (gyro only). */
+    GOVERNOR_LEVEL_SMALL_FFT,   /**< Use FFT_SMALL_SIZE instead of FFT_BUFFER_SIZE. */
+    GOVERNOR_LEVEL_COUNT
+} governor_level_t;
+
+/**
+ * @brief Feed one load measurement and step the level if needed.
+ * @param cpu_usage_pct CPU usage over the last period (0..100).
+ * @param backlog Largest mailbox backlog over the last period (samples).
+ */
+void governor_update(uint8_t cpu_usage_pct, uint32_t backlog);
+
+/**
+ * @brief Get the current degradation level.
+ */
+governor_level_t governor_get_level();
+
+/**
+ * @brief Samples between two spectral computations at the current level.
+ */
+uint32_t governor_hop_size();
+
+/**
+ * @brief Whether accelerometer spectra are computed at the current level.
+ */
+bool governor_accel_enabled();
+
+/**
+ * @brief Whether the reduced FFT size is used at the current level.
+ */
+bool governor_small_fft();
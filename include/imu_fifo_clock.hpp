@@ -0,0 +1,62 @@
+#pragma once
+
+/**
+ * @file imu_fifo_clock.hpp
+ * @brief Sample timestamps and lost-sample estimate for the IMU FIFO mode.
+ *
+ * FIFO samples carry no timestamp, so they are placed on the ODR grid. When
+ * the FIFO is first read (or after lost data, or drift beyond one period),
+ * the newest queued sample is anchored to the read time and earlier samples
+ * are placed 1/ODR apart. Later batches continue from the anchor, so sample
+ * spacing stays exact.
+ *
+ * Samples lost to an overrun or a failed read are estimated from the time
+ * between the next expected sample and the new anchor, so every lost slot
+ * still takes a sequence number.
+ *
+ * Times are us_ticker values; arithmetic is modulo 2^32 and wraps
+ * consistently. No Mbed dependency.
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief Clock state (zero-initialized by imu_fifo_clock_init()).
+ */
+typedef struct {
+    uint32_t rate_hz;       /**< Sensor ODR. */
+    uint32_t period_us;     /**< 1/ODR, rounded down, for the thresholds. */
+    uint32_t anchor_us;     /**< Time of sample 0 of the current anchor. */
+    uint32_t sample_index;  /**< Index of the next sample after the anchor. */
+    bool anchored;          /**< An anchor has been set. */
+    bool lost_data;         /**< Data lost since the last batch; re-anchor. */
+} imu_fifo_clock_t;
+
+/**
+ * @brief Reset the clock; the next batch sets the first anchor.
+ */
+void imu_fifo_clock_init(imu_fifo_clock_t *clock, uint32_t rate_hz);
+
+/**
+ * @brief Align the clock to a batch of queued samples.
+ *
+ * Re-anchors if needed so the newest of the `available` samples maps to
+ * `now_us`.
+ *
+ * @param now_us us_ticker time of the FIFO level read.
+ * @param available Complete samples in the FIFO (> 0).
+ * @return Estimated samples lost since the previous batch (0 unless data
+ *         was lost).
+ */
+uint32_t imu_fifo_clock_batch(imu_fifo_clock_t *clock, uint32_t now_us, uint32_t available);
+
+/**
+ * @brief Timestamp of the next sample of the batch; advances the clock.
+ */
+uint32_t imu_fifo_clock_next(imu_fifo_clock_t *clock);
+
+/**
+ * @brief Record lost data: an overrun (`skipped` = 0) or `skipped` samples
+ *        that were dequeued but not delivered.
+ */
+void imu_fifo_clock_lost(imu_fifo_clock_t *clock, uint32_t skipped);
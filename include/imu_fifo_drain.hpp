@@ -0,0 +1,50 @@
+#pragma once
+
+/**
+ * @file imu_fifo_drain.hpp
+ * @brief One FIFO-mode batch: read the level, drain the FIFO, stamp samples.
+ *
+ * Shared by imu_task's FIFO loop and the host test, so the test runs the
+ * same level read, overrun handling, chunked burst reads and sequence
+ * numbering as the firmware. Delivery (mailbox, test checks) is left to a
+ * per-sample callback.
+ */
+
+#include <stdint.h>
+#include "mbed.h"
+#include "bsp/imu.hpp"
+#include "imu_fifo_clock.hpp"
+
+/**
+ * @brief Receives one drained sample.
+ *
+ * Arguments: raw gyro x/y/z and accel x/y/z words, reconstructed timestamp
+ * (us_ticker) and sequence number.
+ */
+typedef Callback<void(const int16_t *raw, uint32_t timestamp_us, uint32_t seq)> imu_fifo_sink_t;
+
+/**
+ * @brief Outcome of imu_fifo_drain().
+ */
+typedef struct {
+    int available;          /**< Complete samples found, or -1 if the FIFO status read failed. */
+    bool overrun;           /**< The FIFO overflowed since the previous batch. */
+    uint32_t lost;          /**< Samples estimated lost before this batch (numbered, not delivered). */
+    uint32_t read_failed;   /**< Samples dequeued by a failed burst read (numbered, not delivered). */
+    uint32_t delivered;     /**< Samples passed to the sink. */
+} imu_fifo_batch_t;
+
+/**
+ * @brief Drain every complete sample currently in the FIFO.
+ *
+ * Reads in bursts of IMU_FIFO_READ_CHUNK samples and stops at the first
+ * failed burst; the samples it dequeued are reported so the next batch
+ * re-anchors the clock. Every sample slot, delivered or not, takes a
+ * sequence number.
+ *
+ * @param clock FIFO sample clock (imu_fifo_clock_init() once before the first batch).
+ * @param seq In/out: sequence number of the last sample.
+ * @param sink Called for each delivered sample, in order.
+ * @param batch Output: what happened.
+ */
+void imu_fifo_drain(imu_fifo_clock_t *clock, uint32_t *seq, imu_fifo_sink_t sink, imu_fifo_batch_t *batch);
@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * @file latency.hpp
+ * @brief Sample-to-output latency histograms.
+ *
+ * Every spectrum carries the data-ready time of its newest sample, and every
+ * status change published by the analysis task carries that time plus the time
+ * of the decision (see motion_status_publish_traced()). The pipeline stages
+ * record the intervals below, and test_task logs them as histograms with every
+ * report (microseconds, same layout as the stage profiler).
+ *
+ * Each interval is recorded by one thread at a time. The report reads without
+ * locking, so it may mix values from two consecutive records.
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief Measured intervals.
+ */
+typedef enum {
+    LATENCY_SAMPLE_TO_SPECTRUM = 0,     /**< Newest sample -> spectrum computed (every spectrum). */
+    LATENCY_SPECTRUM_TO_DECISION,       /**< Spectrum computed -> filtered status published (every frame). */
+    LATENCY_SAMPLE_TO_DECISION,         /**< Newest sample -> filtered status published (every frame). */
+    LATENCY_DECISION_TO_LED,            /**< Status change -> LEDs updated. */
+    LATENCY_DECISION_TO_BLE,            /**< Status change -> BLE notification written. */
+    LATENCY_SAMPLE_TO_LED,              /**< Newest sample -> LEDs updated (status changes only). */
+    LATENCY_SAMPLE_TO_BLE,              /**< Newest sample -> BLE notification written (status changes only). */
+    LATENCY_COUNT
+} latency_stage_t;
+
+/**
+ * @brief RAM of the latency histograms (profile_stats_t, profiler.hpp).
+ */
+#define LATENCY_STATS_BYTES (LATENCY_COUNT * sizeof(profile_stats_t))
+
+/**
+ * @brief Clear all histograms (call once at start-up).
+ */
+void latency_init();
+
+/**
+ * @brief Add one interval to a histogram.
+ * @param stage Interval measured.
+ * @param start_us Start time (us_ticker).
+ * @param end_us End time (us_ticker); the difference is wrap-safe.
+ */
+void latency_record(latency_stage_t stage, uint32_t start_us, uint32_t end_us);
+
+/**
+ * @brief Record decision->output and sample->output for a traced status change.
+ *
+ * Does nothing if the change was untraced (e.g. published by the activity
+ * gate) or is no longer in the trace ring.
+ *
+ * @param decision_stage LATENCY_DECISION_TO_LED or LATENCY_DECISION_TO_BLE.
+ * @param sample_stage LATENCY_SAMPLE_TO_LED or LATENCY_SAMPLE_TO_BLE.
+ * @param generation Generation of the status that was output.
+ */
+void latency_record_output(latency_stage_t decision_stage, latency_stage_t sample_stage, uint32_t generation);
+
+/**
+ * @brief Log every histogram seen since the last call, then reset them.
+ */
+void latency_report();
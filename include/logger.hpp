@@ -6,8 +6,32 @@
  *
  * This logger prints a timestamp, level, and current RTOS thread name, then
  * the user message. Output is serialized using the BSP serial lock.
+ *
+ * With the build option LOG_DEFERRED, LOG_DEBUG/INFO/WARN do not format in
+ * the caller once log_deferred_start() has run. They copy a binary record
+ * (format string pointer, us_ticker timestamp, thread name, raw argument
+ * words) into a lock-free ring, and a low-priority drain thread formats it
+ * later. When the ring is full the new record is dropped and counted; the
+ * caller never waits. ERROR and FATAL, and everything logged before
+ * log_deferred_start(), are still printed directly.
+ *
+ * Deferred `%s` arguments are stored as pointers, so they must still be
+ * valid when the record is drained (literals, names, static buffers).
+ *
+ * Filtering is per module. A source file selects its module by defining
+ * LOG_MODULE before its includes (default LOG_MODULE_MAIN). A LOG_* call
+ * below the module's compile-time minimum (LOG_MIN_LEVEL_<MODULE>, default
+ * LOG_MIN_LEVEL, default DEBUG) is a constant-false branch and compiles to
+ * nothing. The others check the global and per-module runtime thresholds
+ * inline, so filtered calls evaluate and pass no arguments.
  */
 
+#ifdef LOG_DEFERRED
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#endif
+
 /**
  * @brief Log severity levels (increasing).
  */
@@ -19,6 +43,85 @@ typedef enum {
     LOG_LEVEL_FATAL
 } LogLevel_t;
 
+/**
+ * @brief Log modules with their own compile-time and runtime thresholds.
+ */
+typedef enum {
+    LOG_MODULE_MAIN = 0,    /**< main, BSP, RAM budget and everything untagged. */
+    LOG_MODULE_IMU,         /**< imu_task, adaptive ODR, activity gating. */
+    LOG_MODULE_FFT,         /**< fft_task, quality governor. */
+    LOG_MODULE_ANALYSIS,    /**< analysis_task. */
+    LOG_MODULE_LED,         /**< led_task. */
+    LOG_MODULE_BLE,         /**< ble_task. */
+    LOG_MODULE_PIPELINE,    /**< Single-thread and coroutine pipelines. */
+    LOG_MODULE_TEST,        /**< test_task, task monitor, start-up benches. */
+    LOG_MODULE_COUNT
+} LogModule_t;
+
+#ifndef LOG_MODULE
+#define LOG_MODULE LOG_MODULE_MAIN
+#endif
+
+/**
+ * @name Compile-time minimum levels (override with -DLOG_MIN_LEVEL...=LOG_LEVEL_...)
+ * @{
+ */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+#ifndef LOG_MIN_LEVEL_MAIN
+#define LOG_MIN_LEVEL_MAIN LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_IMU
+#define LOG_MIN_LEVEL_IMU LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_FFT
+#define LOG_MIN_LEVEL_FFT LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_ANALYSIS
+#define LOG_MIN_LEVEL_ANALYSIS LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_LED
+#define LOG_MIN_LEVEL_LED LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_BLE
+#define LOG_MIN_LEVEL_BLE LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_PIPELINE
+#define LOG_MIN_LEVEL_PIPELINE LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_TEST
+#define LOG_MIN_LEVEL_TEST LOG_MIN_LEVEL
+#endif
+/** @} */
+
+/**
+ * @brief Compile-time minimum level of a module.
+ */
+static constexpr LogLevel_t log_module_min_level(LogModule_t module) {
+    switch (module) {
+        case LOG_MODULE_IMU:      return LOG_MIN_LEVEL_IMU;
+        case LOG_MODULE_FFT:      return LOG_MIN_LEVEL_FFT;
+        case LOG_MODULE_ANALYSIS: return LOG_MIN_LEVEL_ANALYSIS;
+        case LOG_MODULE_LED:      return LOG_MIN_LEVEL_LED;
+        case LOG_MODULE_BLE:      return LOG_MIN_LEVEL_BLE;
+        case LOG_MODULE_PIPELINE: return LOG_MIN_LEVEL_PIPELINE;
+        case LOG_MODULE_TEST:     return LOG_MIN_LEVEL_TEST;
+        default:                  return LOG_MIN_LEVEL_MAIN;
+    }
+}
+
+/**
+ * @brief Constant `value`: whether `level` is compiled in for `module`.
+ *
+ * A template constant rather than a plain call, so the LOG_* branch is folded
+ * away even in unoptimized builds.
+ */
+template <LogModule_t module, LogLevel_t level>
+struct log_compiled_in {
+    static constexpr bool value = level >= log_module_min_level(module);
+};
+
 /**
  * @name ANSI color escape sequences (used when COLORED_LOG is enabled)
  * @{
@@ -39,6 +142,18 @@ typedef enum {
  */
 extern LogLevel_t g_log_level;
 
+/**
+ * @brief Per-module runtime thresholds (default DEBUG: only g_log_level applies).
+ */
+extern LogLevel_t g_log_module_levels[LOG_MODULE_COUNT];
+
+/**
+ * @brief Runtime check used by the LOG_* macros before any argument is evaluated.
+ */
+static inline bool log_module_enabled(LogModule_t module, LogLevel_t level) {
+    return level >= g_log_level && level >= g_log_module_levels[module];
+}
+
 /**
  * @brief Core log function (printf-style).
  * @param level Log level.
@@ -46,15 +161,148 @@ extern LogLevel_t g_log_level;
  */
 void log_print(LogLevel_t level, const char* format, ...);
 
+#ifdef LOG_DEFERRED
+/**
+ * @name Deferred logging (build option LOG_DEFERRED)
+ * @{
+ */
+#define LOG_DEFERRED_RECORDS 64                     /**< Ring slots (power of two). */
+#define LOG_DEFERRED_MAX_WORDS 16                   /**< 32-bit argument words per record. */
+#define LOG_DEFERRED_DIRECT_LEVEL LOG_LEVEL_ERROR   /**< Levels from here on are printed directly. */
+#define LOG_DRAIN_PERIOD 20ms                       /**< Drain thread polling period. */
+#define LOG_DRAIN_STACK_SIZE 2048                   /**< Drain thread stack (bytes). */
+/** @} */
+
+/**
+ * @brief One deferred log record (one ring slot).
+ *
+ * `sequence` implements the ring protocol: a slot is free for position `pos`
+ * when sequence == pos, and holds a committed record when sequence == pos + 1.
+ */
+typedef struct log_record_t {
+    std::atomic<uint32_t> sequence;
+    const char *format;         /**< Format string; doubles as the format id. */
+    const char *thread_name;    /**< Name of the logging thread. */
+    uint32_t time_us;           /**< us_ticker time of the call. */
+    uint8_t level;              /**< LogLevel_t. */
+    uint8_t word_count;         /**< Argument words used. */
+    uint8_t truncated;          /**< Arguments did not fit in `words`. */
+    uint32_t words[LOG_DEFERRED_MAX_WORDS];   /**< Arguments, each rounded up to whole words. */
+} log_record_t;
+
+/**
+ * @brief RAM of the deferred log ring.
+ */
+#define LOG_DEFERRED_RING_BYTES (LOG_DEFERRED_RECORDS * sizeof(log_record_t))
+
+/**
+ * @brief Set by log_deferred_start(); before that all levels print directly.
+ */
+extern std::atomic<bool> g_log_deferred;
+
+/**
+ * @brief Start the drain thread and switch LOG_DEBUG/INFO/WARN to the ring.
+ */
+void log_deferred_start();
+
+/**
+ * @brief Claim a ring slot for a new record.
+ * @return Slot to fill and commit, or nullptr if the ring is full (counted as a drop).
+ */
+log_record_t *log_deferred_reserve(LogLevel_t level, const char *format);
+
+/**
+ * @brief Publish a record filled after log_deferred_reserve().
+ */
+void log_deferred_commit(log_record_t *record);
+
+/**
+ * @brief Total records dropped because the ring was full.
+ */
+uint32_t log_deferred_dropped();
+
+/**
+ * @brief Format and print all committed records (called by the drain thread).
+ */
+void log_drain();
+
+// Argument capture: each argument is stored as its raw bytes, rounded up to
+// whole words. The drain thread walks the format string to read them back.
+static inline void log_pack_bytes(log_record_t *record, const void *value, size_t size) {
+    size_t words = (size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    if (record->word_count + words > LOG_DEFERRED_MAX_WORDS) {
+        record->truncated = 1;
+        return;
+    }
+    memcpy(&record->words[record->word_count], value, size);
+    record->word_count += (uint8_t)words;
+}
+
+// Same argument types as after default promotion in a printf call.
+static inline void log_pack_arg(log_record_t *record, int value) { log_pack_bytes(record, &value, sizeof(value)); }
+static inline void log_pack_arg(log_record_t *record, unsigned int value) { log_pack_bytes(record, &value, sizeof(value)); }
+static inline void log_pack_arg(log_record_t *record, long value) { log_pack_bytes(record, &value, sizeof(value)); }
+static inline void log_pack_arg(log_record_t *record, unsigned long value) { log_pack_bytes(record, &value, sizeof(value)); }
+static inline void log_pack_arg(log_record_t *record, long long value) { log_pack_bytes(record, &value, sizeof(value)); }
+static inline void log_pack_arg(log_record_t *record, unsigned long long value) { log_pack_bytes(record, &value, sizeof(value)); }
+static inline void log_pack_arg(log_record_t *record, double value) { log_pack_bytes(record, &value, sizeof(value)); }
+static inline void log_pack_arg(log_record_t *record, const void *value) { log_pack_bytes(record, &value, sizeof(value)); }
+
+static inline void log_pack(log_record_t *record) {
+    (void)record;
+}
+
+template <typename T, typename... Rest>
+static inline void log_pack(log_record_t *record, const T &arg, const Rest &... rest) {
+    log_pack_arg(record, arg);
+    log_pack(record, rest...);
+}
+
+/**
+ * @brief Deferred log entry point used by the LOG_* macros.
+ */
+template <typename... Args>
+static inline void log_deferred(LogLevel_t level, const char *format, const Args &... args) {
+    if (level < g_log_level) {
+        return;
+    }
+    if (level >= LOG_DEFERRED_DIRECT_LEVEL || !g_log_deferred.load(std::memory_order_relaxed)) {
+        log_print(level, format, args...);
+        return;
+    }
+    log_record_t *record = log_deferred_reserve(level, format);
+    if (record != nullptr) {
+        log_pack(record, args...);
+        log_deferred_commit(record);
+    }
+}
+
+// DEBUG/INFO/WARN go through the ring; ERROR/FATAL stay direct.
+#define LOG_EMIT_DEFERRABLE log_deferred
+#else
+static inline void log_deferred_start() {}
+
+#define LOG_EMIT_DEFERRABLE log_print
+#endif
+
+/**
+ * @brief Filter on the module's compile-time and runtime thresholds, then emit.
+ */
+#define LOG_AT(emit, level, fmt, ...) do { \
+        if (log_compiled_in<LOG_MODULE, level>::value && log_module_enabled(LOG_MODULE, level)) { \
+            emit(level, fmt, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
 /**
  * @name Convenience macros
  * @{
  */
-#define LOG_DEBUG(fmt, ...) log_print(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
-#define LOG_INFO(fmt, ...)  log_print(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
-#define LOG_WARN(fmt, ...)  log_print(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
-#define LOG_ERROR(fmt, ...) log_print(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
-#define LOG_FATAL(fmt, ...) log_print(LOG_LEVEL_FATAL, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(fmt, ...) LOG_AT(LOG_EMIT_DEFERRABLE, LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)  LOG_AT(LOG_EMIT_DEFERRABLE, LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  LOG_AT(LOG_EMIT_DEFERRABLE, LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...) LOG_AT(log_print, LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_FATAL(fmt, ...) LOG_AT(log_print, LOG_LEVEL_FATAL, fmt, ##__VA_ARGS__)
 /** @} */
 
 /**
@@ -62,3 +310,10 @@ void log_print(LogLevel_t level, const char* format, ...);
  * @param level Minimum level that will be printed.
  */
 void log_set_level(LogLevel_t level);
+
+/**
+ * @brief Set the runtime threshold of one module.
+ * @param module Module to configure.
+ * @param level Minimum level printed for that module (on top of g_log_level).
+ */
+void log_set_module_level(LogModule_t module, LogLevel_t level);
@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * @file mem_placement.hpp
+ * @brief Section annotations for hot code and hot data (build option MEM_PLACEMENT).
+ *
+ * On the STM32L475, flash runs with wait states behind the ART accelerator,
+ * while SRAM2 is also mapped at 0x10000000 where the core fetches from it
+ * over the I-code bus with zero wait states. With MEM_PLACEMENT:
+ * - MEM_FAST_CODE functions, and the CMSIS FFT kernels named in
+ *   scripts/mem_placement.ld, run from SRAM2 (copied from flash by
+ *   mem_placement_init()).
+ * - MEM_FAST_BSS objects (FFT scratch, sample windows) are grouped in SRAM1,
+ *   so their loads go over the system bus while code is fetched from SRAM2.
+ *   The section is not zeroed at startup: owners must initialize it.
+ *
+ * Without MEM_PLACEMENT the annotations expand to nothing.
+ */
+
+#ifdef MEM_PLACEMENT
+#define MEM_FAST_CODE __attribute__((section(".ramfunc"), noinline))
+#define MEM_FAST_BSS  __attribute__((section(".fast_bss")))
+
+/**
+ * @brief Copy the .ramfunc image from flash to SRAM2.
+ *
+ * Must run before any MEM_FAST_CODE function is called (first thing in main).
+ */
+void mem_placement_init();
+#else
+#define MEM_FAST_CODE
+#define MEM_FAST_BSS
+
+static inline void mem_placement_init() {}
+#endif
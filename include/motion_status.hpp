@@ -0,0 +1,139 @@
+#pragma once
+
+/**
+ * @file motion_status.hpp
+ * @brief Atomically published motion status word with change notification.
+ *
+ * The analysis task publishes the three filtered detector outputs as a single
+ * 32-bit word (flags + generation counter). Readers always get a consistent
+ * snapshot with one atomic load, and interested tasks can block until the
+ * generation changes instead of polling.
+ *
+ * Word layout:
+ *   bits  0..7  : MOTION_STATUS_* flags
+ *   bits  8..31 : generation counter (incremented on every change, wraps)
+ *
+ * Changes published with motion_status_publish_traced() also carry the
+ * data-ready time of the newest sample behind the decision and the time of the
+ * decision itself, so the output tasks can measure end-to-end latency.
+ */
+
+#include <stdint.h>
+#include "mbed.h"
+
+/**
+ * @name Status flags (bits 0..7 of the status word)
+ * @{
+ */
+#define MOTION_STATUS_TREMOR        (1u << 0)
+#define MOTION_STATUS_DYSKINESIA    (1u << 1)
+#define MOTION_STATUS_FOG           (1u << 2)
+#define MOTION_STATUS_FLAGS_MASK    0xFFu
+/** @} */
+
+#define MOTION_STATUS_GENERATION_SHIFT 8
+
+/**
+ * @name Waiter IDs
+ * Each waiting task owns one event flag bit so that a single publish wakes all
+ * of them independently.
+ * @{
+ */
+#define MOTION_STATUS_WAITER_LED    (1u << 0)
+/** @} */
+
+/**
+ * @brief Maximum number of change callbacks that can be registered.
+ */
+#define MOTION_STATUS_MAX_CALLBACKS 2
+
+/**
+ * @brief Number of recent changes whose trace is kept (power of two).
+ */
+#define MOTION_STATUS_TRACE_DEPTH 4
+
+/**
+ * @brief Decoded snapshot of the status word.
+ */
+typedef struct {
+    uint8_t flags;          /**< MOTION_STATUS_* bits. */
+    uint32_t generation;    /**< Change counter (24-bit, wraps). */
+} motion_status_t;
+
+/**
+ * @brief Timestamps attached to a traced status change (us_ticker).
+ */
+typedef struct motion_status_trace_t {
+    uint32_t sample_time_us;    /**< Data-ready time of the newest sample in the analyzed window. */
+    uint32_t decision_time_us;  /**< Time the change was published. */
+} motion_status_trace_t;
+
+/**
+ * @brief RAM of the trace ring (each slot holds a tag word and a trace).
+ */
+#define MOTION_STATUS_TRACE_BYTES (MOTION_STATUS_TRACE_DEPTH * (sizeof(uint32_t) + sizeof(motion_status_trace_t)))
+
+/**
+ * @brief Publish a new set of status flags.
+ *
+ * If the flags differ from the current ones, the generation counter is
+ * incremented, all waiters are woken and registered callbacks are invoked in
+ * the caller's context. Publishing identical flags is a no-op.
+ *
+ * @param flags New MOTION_STATUS_* bits.
+ * @return true if the status changed.
+ */
+bool motion_status_publish(uint8_t flags);
+
+/**
+ * @brief Publish a new set of status flags with the time of the newest sample.
+ *
+ * Same as motion_status_publish(), but a change also records a trace that
+ * motion_status_get_trace() returns for the new generation.
+ *
+ * @param flags New MOTION_STATUS_* bits.
+ * @param sample_time_us Data-ready time of the newest sample behind the flags.
+ * @return true if the status changed.
+ */
+bool motion_status_publish_traced(uint8_t flags, uint32_t sample_time_us);
+
+/**
+ * @brief Read a consistent snapshot of the current status.
+ * @return Decoded status (flags + generation).
+ */
+motion_status_t motion_status_get();
+
+/**
+ * @brief Read the trace of a status change.
+ *
+ * @param generation Generation returned by motion_status_get() or motion_status_wait().
+ * @param trace Output: timestamps of that change.
+ * @return false if the change was untraced or is older than the last
+ *         MOTION_STATUS_TRACE_DEPTH changes.
+ */
+bool motion_status_get_trace(uint32_t generation, motion_status_trace_t *trace);
+
+/**
+ * @brief Wait until the status generation differs from `last_generation`.
+ *
+ * Returns immediately if a change already happened since `last_generation`.
+ *
+ * @param waiter One MOTION_STATUS_WAITER_* bit owned by the caller.
+ * @param last_generation Generation the caller has already seen.
+ * @param timeout Maximum time to wait.
+ * @param status Output: snapshot after the wait (always written).
+ * @return true if the generation changed, false on timeout.
+ */
+bool motion_status_wait(uint32_t waiter, uint32_t last_generation, Kernel::Clock::duration timeout, motion_status_t *status);
+
+/**
+ * @brief Register a callback invoked from the publisher on every change.
+ *
+ * Callbacks run in the analysis task context and must be short (e.g. post
+ * an event to an EventQueue). Register from main() before the tasks start;
+ * registration is not synchronized with publishing.
+ *
+ * @param cb Callback to invoke.
+ * @return true on success, false if all callback slots are used.
+ */
+bool motion_status_on_change(Callback<void()> cb);
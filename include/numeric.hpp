@@ -0,0 +1,49 @@
+#pragma once
+
+/**
+ * @file numeric.hpp
+ * @brief Single-precision constants and helpers for the hot paths.
+ *
+ * The Cortex-M4F has a single-precision FPU only: every double operation is a
+ * software library call. Constants here carry the `f` suffix and helpers take
+ * and return float32_t, so expressions built from them never promote. Sources
+ * in src/ are compiled with -Werror=double-promotion to keep it that way;
+ * float arguments to LOG_* must be cast to (double) explicitly (printf
+ * varargs promote anyway, the cast marks it as intended).
+ */
+
+#include "arm_math.h"
+
+/**
+ * @name Constants
+ * @{
+ */
+#define NUMERIC_EPSILON     1e-6f                            /**< Added to denominators against divide-by-zero. */
+#define NUMERIC_PI          3.14159265358979f
+#define NUMERIC_DEG_TO_RAD  (NUMERIC_PI / 180.0f)
+/** @} */
+
+/**
+ * @brief Ratio with an epsilon-guarded denominator: num / (den + NUMERIC_EPSILON).
+ */
+static inline float32_t numeric_ratio(float32_t num, float32_t den) {
+    return num / (den + NUMERIC_EPSILON);
+}
+
+/**
+ * @brief Convert degrees to radians.
+ */
+static inline float32_t numeric_deg_to_rad(float32_t deg) {
+    return deg * NUMERIC_DEG_TO_RAD;
+}
+
+#ifdef NUMERIC_BENCH
+/**
+ * @brief Measure double-promoting vs float-only forms of the hot-path math.
+ *
+ * Runs once at start-up (build option NUMERIC_BENCH) and logs the DWT cycle
+ * counts per sample (gyro unit conversion) and per frame (detector ratios),
+ * and the cycles recovered per second at the nominal rates.
+ */
+void numeric_bench_run();
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+ * @file pipeline.hpp
+ * @brief Single-thread cooperative pipeline (build option PIPELINE_SINGLE_THREAD).
+ *
+ * Instead of six RTOS threads handing data through kernel objects, all stages
+ * run as run-to-completion handlers on one EventQueue-driven thread, in a fixed
+ * order per sample:
+ *
+ *   IMU drain -> spectral (every PIPELINE_ANALYSIS_DECIMATION samples)
+ *             -> analysis -> output (LED, BLE notify)
+ *
+ * The data-ready interrupt posts one event per sample. LED animation, the IMU
+ * watchdog and diagnostics are periodic events on the same queue, and the BLE
+ * stack uses the same queue for its processing.
+ *
+ * PIPELINE_COROUTINES is an alternative single-thread build in which the same
+ * stages are written as C++20 coroutines (see `coro.hpp`).
+ */
+
+#include "mbed.h"
+#include "bsp/imu.hpp"
+
+/**
+ * @brief Stack size of the single pipeline thread.
+ *
+ * It hosts FFT, analysis, BLE processing and logging, so it gets more room
+ * than a single default task stack.
+ */
+#define PIPELINE_STACK_SIZE (OS_STACK_SIZE * 2)
+
+/**
+ * @brief Sum of the task stacks the threaded build allocates (used for the RAM report).
+ */
+#define PIPELINE_THREADED_STACK_BYTES (IMU_TASK_STACK_SIZE + FFT_TASK_STACK_SIZE + ANALYSIS_TASK_STACK_SIZE \
+    + LED_TASK_STACK_SIZE + BLE_TASK_STACK_SIZE + TEST_TASK_STACK_SIZE)
+
+/**
+ * @brief Event queue capacity (number of pending events).
+ */
+#define PIPELINE_QUEUE_EVENTS 32
+
+/**
+ * @brief RAM of the event queue buffer.
+ */
+#define PIPELINE_QUEUE_BYTES (PIPELINE_QUEUE_EVENTS * EVENTS_EVENT_SIZE)
+
+/**
+ * @brief Samples between two spectral + analysis passes (~100 ms).
+ *
+ * Spectra are only consumed by the analysis stage, so in this mode they are
+ * computed at the analysis cadence instead of on every sample.
+ */
+#define PIPELINE_ANALYSIS_DECIMATION (IMU_SAMPLE_RATE_HZ / 10)
+
+/**
+ * @brief Thread entry: initialize all stages and dispatch the queue forever.
+ */
+void pipeline_task();
+
+/**
+ * @brief Thread entry for the coroutine build (PIPELINE_COROUTINES).
+ *
+ * Runs the same stages as coroutines on the executor in `coro.hpp`; BLE keeps
+ * its own thread.
+ */
+void pipeline_coro_task();
+
+/**
+ * @brief Log the sample, frame and event rates since the last report, with
+ *        a formula estimate of the context switches avoided.
+ */
+void pipeline_report();
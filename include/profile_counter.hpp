@@ -0,0 +1,55 @@
+#pragma once
+
+/**
+ * @file profile_counter.hpp
+ * @brief Free-running cycle counter shared by the profiler, the trace buffer
+ *        and the start-up benches.
+ *
+ * On target the counter is the DWT cycle counter; on a Linux host it is the
+ * steady clock in nanoseconds.
+ */
+
+#include <stdint.h>
+
+#ifdef __linux__
+#include <chrono>
+
+#define PROFILE_UNIT "ns"
+
+static inline void profile_counter_enable() {}
+
+static inline uint32_t profile_counter_now() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#else
+#include "mbed.h"
+
+#define PROFILE_UNIT "cyc"
+
+/**
+ * @brief Start the DWT cycle counter (idempotent; the count is not reset).
+ */
+static inline void profile_counter_enable() {
+    CoreDebug->DEMCR = CoreDebug->DEMCR | CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL = DWT->CTRL | DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief Current counter value; differences are wrap-safe in uint32_t.
+ */
+static inline uint32_t profile_counter_now() {
+    return DWT->CYCCNT;
+}
+#endif
+
+/**
+ * @brief Counter ticks per second.
+ */
+static inline uint32_t profile_counter_hz() {
+#ifdef __linux__
+    return 1000000000u;
+#else
+    return SystemCoreClock;
+#endif
+}
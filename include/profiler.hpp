@@ -0,0 +1,153 @@
+#pragma once
+
+/**
+ * @file profiler.hpp
+ * @brief Per-stage cycle profiler with histograms (build option STAGE_PROFILE).
+ *
+ * PROFILE_SCOPE(stage) measures the enclosing scope and adds the result to
+ * that stage's statistics: count, min, mean, max and a histogram with
+ * power-of-two buckets. test_task dumps and resets the statistics with every
+ * report. On target the unit is DWT cycles; on a Linux host it is
+ * nanoseconds from the steady clock.
+ *
+ * Each stage should be recorded by one thread at a time. The report reads
+ * without locking, so it may mix values from two consecutive probes.
+ *
+ * With TRACE_BUFFER, PROFILE_SCOPE also records stage begin/end events in the
+ * trace ring (trace.hpp). Without either option it expands to nothing. The
+ * counter helpers (profile_counter.hpp) are always available and are shared
+ * with the start-up benches; the profile_stats_* histogram helpers are shared
+ * with the latency tracker.
+ */
+
+#include <stdint.h>
+#include "profile_counter.hpp"
+#include "trace.hpp"
+
+/**
+ * @brief Profiled stages.
+ */
+typedef enum {
+    PROFILE_STAGE_IMU_READ_RAW = 0,     /**< imu_read_raw(): one burst read over I2C. */
+    PROFILE_STAGE_IMU_READ_FIFO,        /**< imu_fifo_read(): one FIFO chunk. */
+    PROFILE_STAGE_MIRROR_PUSH,          /**< One six-axis push into the windows. */
+    PROFILE_STAGE_WINDOW_LOAD,          /**< int16 window -> fft_input (one axis). */
+    PROFILE_STAGE_RFFT,                 /**< arm_rfft_fast_f32 (one axis). */
+    PROFILE_STAGE_PSD,                  /**< Magnitude, square and scale (one axis). */
+    PROFILE_STAGE_DETECT_TREMOR,        /**< detectTremor() (one axis). */
+    PROFILE_STAGE_DETECT_DYSKINESIA,    /**< detectDyskinesia() (one axis). */
+    PROFILE_STAGE_DETECT_FOG,           /**< detectFOG() (one axis). */
+    PROFILE_STAGE_COUNT
+} profile_stage_t;
+
+/**
+ * @name Histogram layout
+ * Bucket 0 counts durations below 2^PROFILE_BUCKET_SHIFT, bucket i counts
+ * [2^(SHIFT+i-1), 2^(SHIFT+i)), and the last bucket is open-ended.
+ * @{
+ */
+#define PROFILE_BUCKETS 16
+#define PROFILE_BUCKET_SHIFT 6
+/** @} */
+
+/**
+ * @brief Duration statistics since the last report.
+ *
+ * Also used by the latency tracker (latency.hpp), whose unit is microseconds.
+ */
+typedef struct profile_stats_t {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[PROFILE_BUCKETS];
+} profile_stats_t;
+
+/**
+ * @brief RAM of the per-stage statistics (STAGE_PROFILE).
+ */
+#define PROFILE_STATS_BYTES (PROFILE_STAGE_COUNT * sizeof(profile_stats_t))
+
+/**
+ * @brief Clear a statistics block (min starts at UINT32_MAX).
+ */
+void profile_stats_reset(profile_stats_t *stats);
+
+/**
+ * @brief Add one duration to a statistics block.
+ */
+void profile_stats_add(profile_stats_t *stats, uint32_t elapsed);
+
+/**
+ * @brief Log count/min/mean/max and the histogram of a statistics block (INFO).
+ * @param prefix Row prefix (e.g. "Profile").
+ * @param name Row label.
+ * @param stats Statistics to print; nothing is logged if the count is zero.
+ * @param unit Unit suffix of the durations.
+ */
+void profile_stats_log(const char *prefix, const char *name, const profile_stats_t *stats, const char *unit);
+
+/**
+ * @brief Name of a stage (used by the report and the trace dump).
+ */
+const char *profile_stage_name(profile_stage_t stage);
+
+#ifdef STAGE_PROFILE
+
+/**
+ * @brief Enable the counter and clear all statistics (call once at start-up).
+ */
+void profile_init();
+
+/**
+ * @brief Add one measurement to a stage.
+ * @param stage Stage measured.
+ * @param elapsed Duration in PROFILE_UNIT.
+ */
+void profile_record(profile_stage_t stage, uint32_t elapsed);
+
+/**
+ * @brief Log the statistics and histogram of every stage seen, then reset them.
+ */
+void profile_report();
+#else
+static inline void profile_init() {}
+static inline void profile_report() {}
+#endif
+
+#if defined(STAGE_PROFILE) || defined(TRACE_BUFFER)
+
+/**
+ * @brief Scope guard behind PROFILE_SCOPE().
+ *
+ * Records the duration with STAGE_PROFILE and stage begin/end events with
+ * TRACE_BUFFER.
+ */
+class profile_scope {
+public:
+    explicit profile_scope(profile_stage_t stage) : stage(stage), start(profile_counter_now()) {
+        trace_record(TRACE_STAGE_BEGIN, stage);
+    }
+    ~profile_scope() {
+#ifdef STAGE_PROFILE
+        profile_record(stage, profile_counter_now() - start);
+#endif
+        trace_record(TRACE_STAGE_END, stage);
+    }
+
+private:
+    profile_stage_t stage;
+    uint32_t start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+/**
+ * @brief Measure the rest of the enclosing scope as `stage`.
+ */
+#define PROFILE_SCOPE(stage) profile_scope PROFILE_CONCAT(profile_scope_, __LINE__)(stage)
+
+#else
+#define PROFILE_SCOPE(stage)
+#endif
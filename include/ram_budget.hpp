@@ -0,0 +1,49 @@
+#pragma once
+
+/**
+ * @file ram_budget.hpp
+ * @brief Compile-time RAM budget of the statically allocated system objects.
+ *
+ * Task stacks, DSP buffers, queues and result rings are all sized at compile
+ * time. ram_budget.cpp lists them for the active build mode, checks the total
+ * against RAM_BUDGET_LIMIT_BYTES with a static_assert, and logs the table at
+ * start-up. scripts/mem_report.py prints the same groups from the linked
+ * symbol sizes after every build.
+ *
+ * Each entry is a stack size or *_BYTES constant from the owning module's
+ * header, and a static_assert next to the object's definition checks it
+ * against sizeof(), so the table cannot drift from what is linked. Not
+ * listed, and left to the headroom outside the limit:
+ * - module state of a few words each (task monitors, filters, governor,
+ *   drop counters, coroutine stage table, trace thread table, log levels);
+ * - driver objects in static_storage slots (I2C, pins, PWM, serial);
+ * - the NUMERIC_BENCH sample arrays (under 100 bytes);
+ * - Mbed OS and BLE stack internals (main/ISR stacks, kernel objects, heap).
+ * mem_report.txt lists every linked object, including these.
+ */
+
+#include "mbed.h"
+
+/**
+ * @brief Stack size of every task without a measured size of its own (bytes).
+ *
+ * OS_STACK_SIZE, what the threads ran with before their stacks became static.
+ * No stack has been reclaimed yet: all tasks but ble_task (4 KB for the
+ * Cordio host stack) use this size. To shrink one, give it its peak logged by
+ * test_report() plus TEST_STACK_MARGIN_PCT, measured in the heaviest build
+ * modes.
+ */
+#define TASK_STACK_SIZE_DEFAULT OS_STACK_SIZE
+
+/**
+ * @brief Upper bound for the objects in the budget table (bytes).
+ *
+ * SRAM1 is 96 KB; the remaining 32 KB cover Mbed OS, the BLE stack heap, the
+ * main thread stack and the ISR stack.
+ */
+#define RAM_BUDGET_LIMIT_BYTES (64 * 1024)
+
+/**
+ * @brief Log the RAM budget table (category, object, bytes) and its total.
+ */
+void ram_budget_report();
@@ -0,0 +1,36 @@
+#pragma once
+
+/**
+ * @file static_storage.hpp
+ * @brief Statically allocated slot for an object constructed at run time.
+ *
+ * Drivers such as I2C, PwmOut or InterruptIn are created during the BSP init
+ * sequence, not during static initialization, and LED3 swaps between an input
+ * and a PWM output. static_storage gives these objects a fixed, link-time
+ * sized home: construct() placement-news the object into the slot and
+ * destroy() runs its destructor, so no heap is involved.
+ */
+
+#include <new>
+#include <utility>
+
+/**
+ * @brief Uninitialized, correctly aligned storage for one T.
+ *
+ * Holds at most one live object; the owner tracks whether it is constructed.
+ */
+template <typename T>
+struct static_storage {
+    alignas(T) unsigned char bytes[sizeof(T)];
+
+    /** @brief Construct the object in place and return it. */
+    template <typename... Args>
+    T *construct(Args&&... args) {
+        return new (bytes) T(std::forward<Args>(args)...);
+    }
+
+    /** @brief Destroy the object constructed by construct(). */
+    void destroy() {
+        reinterpret_cast<T*>(bytes)->~T();
+    }
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ * @file task_monitor.hpp
+ * @brief Lightweight activation period / execution budget monitor per task.
+ *
+ * Each task declares its expected activation period and execution budget and
+ * brackets one unit of work with task_monitor_begin()/task_monitor_end(). The
+ * monitor records activation intervals, execution times, worst cases and
+ * misses using the microsecond ticker. test_task prints and resets the
+ * per-window statistics with task_monitor_report().
+ *
+ * A deadline miss is counted when an activation starts more than
+ * TASK_MONITOR_TOLERANCE_PCT late relative to the declared period, or when
+ * the work itself takes longer than one period. Budget overruns are counted
+ * separately.
+ *
+ * Each monitor is written only by its own task; the report reads it without
+ * locking, so a report may mix values from two consecutive activations.
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief Allowed lateness of an activation before it counts as a miss (%).
+ */
+#define TASK_MONITOR_TOLERANCE_PCT 50
+
+/**
+ * @brief Convert a rate in Hz to a period in microseconds.
+ */
+#define TASK_MONITOR_PERIOD_US(hz) (1000000u / (hz))
+
+/**
+ * @brief Timing statistics of one monitored task.
+ */
+typedef struct task_monitor_t {
+    const char *name;
+    uint32_t period_us;             /**< Expected activation period (0 = aperiodic). */
+    uint32_t budget_us;             /**< Execution budget per activation. */
+
+    uint32_t start_us;              /**< Start of the current activation. */
+    uint32_t last_start_us;         /**< Start of the previous activation. */
+    bool started;                   /**< At least one activation seen. */
+
+    // Window statistics (reset on every report).
+    uint32_t activations;
+    uint32_t interval_min_us;
+    uint32_t interval_max_us;
+    uint32_t exec_sum_us;
+    uint32_t exec_max_us;
+
+    // Lifetime statistics.
+    uint32_t worst_interval_us;
+    uint32_t worst_exec_us;
+    uint32_t deadline_misses;
+    uint32_t budget_overruns;
+
+    struct task_monitor_t *next;    /**< Registry link. */
+} task_monitor_t;
+
+/**
+ * @brief Initialize a monitor and add it to the global registry.
+ * @param monitor Monitor storage (must stay valid; typically a static).
+ * @param name Task name used in reports.
+ * @param period_us Expected activation period in microseconds (0 = aperiodic).
+ * @param budget_us Execution budget per activation in microseconds.
+ */
+void task_monitor_register(task_monitor_t *monitor, const char *name, uint32_t period_us, uint32_t budget_us);
+
+/**
+ * @brief Mark the start of one activation.
+ * @param monitor Monitor handle.
+ */
+void task_monitor_begin(task_monitor_t *monitor);
+
+/**
+ * @brief Mark the end of the current activation.
+ * @param monitor Monitor handle.
+ */
+void task_monitor_end(task_monitor_t *monitor);
+
+/**
+ * @brief Forget the previous activation so a planned pause is not counted as
+ *        a deadline miss.
+ * @param monitor Monitor handle.
+ */
+void task_monitor_resync(task_monitor_t *monitor);
+
+/**
+ * @brief Log the statistics of all registered monitors and reset the window.
+ */
+void task_monitor_report();
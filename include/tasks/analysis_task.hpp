@@ -5,6 +5,9 @@
  * @brief Motion classification task (tremor, dyskinesia, FOG) based on FFT PSD.
  */
 
+#include <stdint.h>
+#include "ram_budget.hpp"
+
 /**
  * @name Frequency bands (Hz)
  * These constants define the bands used by the detection algorithms.
@@ -41,17 +44,48 @@
 #define WALKING_STATE_HISTORY 150
 /** @} */
 
+/**
+ * @brief Interval between two analysis steps.
+ */
+#define ANALYSIS_PERIOD 100ms
+
+/**
+ * @brief Execution budget of one analysis step (us).
+ */
+#define ANALYSIS_TASK_BUDGET_US 10000
+
+/**
+ * @brief Stack size of analysis_task (bytes).
+ */
+#define ANALYSIS_TASK_STACK_SIZE TASK_STACK_SIZE_DEFAULT
+
 /**
  * @brief RTOS task that analyzes FFT PSD and updates motion status flags.
  *
  * The task reads the latest FFT result (gyro PSD) and runs three detectors:
  * tremor, dyskinesia, and freezing-of-gait (FOG). Outputs are debounced/
- * smoothed using a boolean filter to avoid flickering decisions.
+ * smoothed using a boolean filter to avoid flickering decisions, then published
+ * as one atomic status word (see `motion_status.hpp`).
  */
 void analysis_task();
 
+/**
+ * @brief Reset detector filters and internal state.
+ */
+void analysis_init();
+
+/**
+ * @brief Run all detectors once on the newest FFT result and publish status.
+ * @return true if a result was processed, false if none could be locked.
+ */
+bool analysis_step();
+
 /**
  * @brief Get the filtered tremor detection status.
+ *
+ * Each getter reads its own snapshot; use motion_status_get() when several
+ * flags must be evaluated consistently.
+ *
  * @return true if tremor is currently detected, otherwise false.
  */
 bool get_tremor_status();
@@ -5,13 +5,50 @@
  * @brief BLE task that advertises a simple status characteristic.
  */
 
+#include "mbed.h"
+#include "events/EventQueue.h"
+
 #define BLE_DEVICE_NAME "Parkinson's-Monitor-Group-46"
 
+/**
+ * @brief Stack size of ble_task (bytes); the Cordio host stack runs on it.
+ */
+#define BLE_TASK_STACK_SIZE 4096
+
+/**
+ * @brief Event capacity of the BLE task's own queue.
+ */
+#define BLE_QUEUE_EVENTS 16
+
+/**
+ * @brief RAM of the BLE task's own queue buffer.
+ */
+#define BLE_QUEUE_BYTES (BLE_QUEUE_EVENTS * EVENTS_EVENT_SIZE)
+
 /**
  * @brief RTOS task entry: initialize BLE stack and run the event queue.
  */
 void ble_task();
 
+/**
+ * @brief Register the status change callback that posts BLE notifications.
+ *
+ * Call from main() before any task starts, so no publish can race the
+ * registration or happen before it.
+ *
+ * @return false if no motion status callback slot is free.
+ */
+bool ble_subscribe_status();
+
+/**
+ * @brief Initialize the BLE stack and run its processing on `queue`.
+ *
+ * The caller is responsible for dispatching the queue.
+ *
+ * @param queue Event queue that executes BLE events and notifications.
+ */
+void ble_init(events::EventQueue *queue);
+
 /**
  * @brief Query whether a BLE central is currently connected.
  * @return true if connected, false otherwise.
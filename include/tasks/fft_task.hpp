@@ -6,6 +6,8 @@
  */
 
 #include "mbed.h"
+#include "ram_budget.hpp"
+#include "buffer.hpp"
 #include "arm_math.h"
 #include "tasks/imu_task.hpp"
 
@@ -18,6 +20,29 @@
  */
 #define FFT_BUFFER_SIZE 256
 
+/**
+ * @brief Reduced FFT size used when the governor is at GOVERNOR_LEVEL_SMALL_FFT
+ *        and while the window is still filling (see FFT_START_FILL).
+ *
+ * The newest FFT_SMALL_SIZE samples of the window are transformed; the PSD
+ * keeps the same scale so detector thresholds stay valid.
+ */
+#define FFT_SMALL_SIZE 128
+
+/**
+ * @brief Samples needed after startup or a restart before spectra start.
+ *
+ * The builds that pause sampling (IMU_ADAPTIVE_ODR, IMU_ACTIVITY_GATING)
+ * start after FFT_SMALL_SIZE samples with the small transform, so the
+ * pipeline resumes quickly after each pause. The other builds wait for a
+ * full window as before.
+ */
+#if defined(IMU_ADAPTIVE_ODR) || defined(IMU_ACTIVITY_GATING)
+#define FFT_START_FILL FFT_SMALL_SIZE
+#else
+#define FFT_START_FILL FFT_BUFFER_SIZE
+#endif
+
 /**
  * @brief Number of FFT result buffers (double-buffering).
  *
@@ -26,6 +51,37 @@
  */
 #define FFT_BUFFER_NUM 2
 
+/**
+ * @brief Longest run of missing samples filled by linear interpolation.
+ *
+ * Longer gaps restart the window instead, so a spectrum never contains more
+ * than this many synthetic samples in a row.
+ */
+#define FFT_MAX_INTERP_GAP 4
+
+
+/**
+ * @brief Execution budget for processing one sample in fft_task (us).
+ *
+ * Must stay below one sample period (1 / IMU_SAMPLE_RATE_HZ) or the mailbox
+ * fills up.
+ */
+#define FFT_TASK_BUDGET_US 4000
+
+/**
+ * @brief Stack size of fft_task (bytes); the FFT scratch buffers are static.
+ */
+#define FFT_TASK_STACK_SIZE TASK_STACK_SIZE_DEFAULT
+
+/**
+ * @brief Sequence-gap statistics of the samples pushed into the windows.
+ */
+typedef struct fft_gap_stats_t {
+    uint32_t gaps;          /**< Gaps detected in the sample sequence. */
+    uint32_t interpolated;  /**< Missing samples filled by interpolation. */
+    uint32_t restarts;      /**< Gaps longer than FFT_MAX_INTERP_GAP (window restarted). */
+    uint32_t stale;         /**< Duplicate or out-of-order samples discarded. */
+} fft_gap_stats_t;
 
 /**
  * @brief FFT output container (per-axis) with a timestamp and mutex.
@@ -39,10 +95,24 @@ typedef struct fft_result_t {
     float32_t gyro_magnitude[3][FFT_BUFFER_SIZE / 2];
     float32_t accel_psd[3][FFT_BUFFER_SIZE / 2];
     float32_t gyro_psd[3][FFT_BUFFER_SIZE / 2];
-    std::chrono::time_point<rtos::Kernel::Clock> timestamp;
+    std::chrono::time_point<rtos::Kernel::Clock> timestamp;        /**< Time the spectrum was computed. */
+    uint32_t sample_time_us;                                       /**< Data-ready time of the newest sample in the window (us_ticker). */
+    uint32_t spectrum_time_us;                                     /**< Time the spectrum was computed (us_ticker). */
+    uint32_t fft_size;      /**< FFT size used; fft_size/2 bins are valid. */
+    bool accel_valid;       /**< false if accel spectra were skipped by the governor. */
     Mutex mutex;
 } fft_result_t;
 
+/**
+ * @name RAM of the fft_task buffers (bytes)
+ * @{
+ */
+#define FFT_SENSOR_BUFFER_BYTES sizeof(mirror_buffer_multi<int16_t, IMU_RAW_WORDS, FFT_BUFFER_SIZE>)
+#define FFT_WORK_BUFFER_BYTES   (FFT_BUFFER_SIZE * sizeof(float32_t))    /**< fft_input or fft_output. */
+#define FFT_HANDLERS_BYTES      (2 * sizeof(arm_rfft_fast_instance_f32)) /**< Full-size and small FFT instances. */
+#define FFT_RESULTS_BYTES       (FFT_BUFFER_NUM * sizeof(fft_result_t))
+/** @} */
+
 /**
  * @brief RTOS task that consumes IMU samples and computes FFT/PSD.
  *
@@ -51,6 +121,51 @@ typedef struct fft_result_t {
  */
 void fft_task();
 
+/**
+ * @brief Reset the sliding-window buffers and initialize the FFT instances.
+ * @return true on success.
+ */
+bool fft_init();
+
+/**
+ * @brief Push one IMU sample into the per-axis sliding windows.
+ *
+ * The sequence number is checked against the previous sample: short gaps
+ * are filled by linear interpolation, longer ones restart the window.
+ *
+ * @param sample Sample to append.
+ */
+void fft_push_sample(const imu_data_t *sample);
+
+/**
+ * @brief Check whether enough samples for a spectrum have been collected.
+ *
+ * Spectra start after FFT_START_FILL samples. When that is less than a full
+ * window, the small transform is used until the window is full.
+ *
+ * @return true once FFT_START_FILL samples have been pushed since the last restart.
+ */
+bool fft_window_ready();
+
+/**
+ * @brief Compute FFT/PSD for all axes into the oldest result buffer.
+ * @param sample_time_us Data-ready time of the newest sample in the window.
+ * @return true on success, false if no result buffer could be locked.
+ */
+bool fft_compute(uint32_t sample_time_us);
+
+/**
+ * @brief Read and reset the largest mailbox backlog drained in one wakeup.
+ * @return Maximum number of queued samples since the last call.
+ */
+uint32_t fft_backlog_get_and_reset();
+
+/**
+ * @brief Read and reset the sequence-gap statistics.
+ * @param stats Output statistics since the last call.
+ */
+void fft_gaps_get_and_reset(fft_gap_stats_t *stats);
+
 /**
  * @brief Find a writable result buffer and lock it.
  * @return Pointer to the locked buffer, or nullptr if none available.
@@ -62,3 +177,18 @@ fft_result_t *fft_find_and_lock_oldest_result();
  * @return Pointer to the locked buffer, or nullptr if none available.
  */
 fft_result_t *fft_find_and_lock_latest_result();
+
+#ifdef PLACEMENT_BENCH
+/**
+ * @brief Rounds averaged by fft_stage_bench_run().
+ */
+#define FFT_STAGE_BENCH_ROUNDS 32
+
+/**
+ * @brief Log average DWT cycles of each FFT stage for one full-size axis.
+ *
+ * Runs once at start-up (build option PLACEMENT_BENCH), so the default and
+ * MEM_PLACEMENT layouts can be compared stage by stage.
+ */
+void fft_stage_bench_run();
+#endif
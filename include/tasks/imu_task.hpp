@@ -8,31 +8,145 @@
 #include <stdint.h>
 #include <time.h>
 #include "mbed.h"
+#include "ram_budget.hpp"
 #include "arm_math.h"
 #include "bsp/imu.hpp"
 
 
 /**
- * @brief One timestamped IMU sample (3-axis accel + gyro).
+ * @brief Execution budget of one imu_task activation (us).
+ */
+#define IMU_TASK_BUDGET_US 2000
+
+/**
+ * @brief Stack size of imu_task (bytes).
+ */
+#define IMU_TASK_STACK_SIZE TASK_STACK_SIZE_DEFAULT
+
+/**
+ * @brief Number of samples the IMU mailbox can hold.
+ */
+#define IMU_MAILBOX_DEPTH 10
+
+/**
+ * @name FIFO mode (build option IMU_FIFO_MODE)
+ * Instead of one wakeup per data-ready edge, the sensor buffers samples in its
+ * on-chip FIFO and raises INT1 at a watermark. imu_task then bulk-reads the
+ * batch and reconstructs per-sample timestamps from the ODR. Watermark and
+ * burst size are in bsp/imu.hpp.
+ * @{
+ */
+#define IMU_FIFO_WAIT_TIMEOUT_MS 500       /**< Poll the FIFO if no watermark edge arrives. */
+#define IMU_FIFO_MAX_IDLE_POLLS 4          /**< Empty polls in a row before a fatal error. */
+#define IMU_FIFO_ALLOC_TIMEOUT 50ms        /**< Wait for a free mailbox slot per sample. */
+/** @} */
+
+#if defined(IMU_FIFO_MODE) && (defined(PIPELINE_SINGLE_THREAD) || defined(PIPELINE_COROUTINES))
+#error "IMU_FIFO_MODE is only supported by the threaded build"
+#endif
+
+/**
+ * @brief One timestamped IMU sample (3-axis gyro + accel), as raw sensor words.
  *
- * Accel units depend on ACC_SENSITIVITY in the IMU BSP.
- * Gyro is converted to rad/s in `imu_read_gyro_data()`.
+ * Samples travel unscaled (20 bytes instead of 32); fft_task converts whole
+ * windows to physical units with IMU_GYRO_SCALE / IMU_ACC_SCALE.
  */
 typedef struct imu_data_t {
-    float32_t accel[3];
-    float32_t gyro[3];
-    std::chrono::time_point<rtos::Kernel::Clock> timestamp;
+    int16_t raw[IMU_RAW_WORDS];  /**< Gyro x/y/z, then accel x/y/z (IMU_RAW_GYRO / IMU_RAW_ACCEL). */
+    uint32_t timestamp_us;  /**< us_ticker time of the data-ready edge (see imu_data_ready_time_us()). */
+    uint32_t seq;           /**< Sample sequence number; dropped samples leave a gap. */
 } imu_data_t;
 
 /**
- * @brief Global mailbox for IMU samples (allocated in imu_task()).
+ * @brief RAM of the IMU mailbox.
+ */
+#define IMU_MAILBOX_BYTES sizeof(Mail<imu_data_t, IMU_MAILBOX_DEPTH>)
+
+/**
+ * @brief Reasons a sample can be lost before it reaches the mailbox.
+ */
+typedef enum {
+    IMU_DROP_MAILBOX_FULL = 0,  /**< No free mailbox slot (consumer behind). */
+    IMU_DROP_BUS_ERROR,         /**< I2C read failed. */
+    IMU_DROP_BUS_BUSY,          /**< Previous asynchronous transfer still running. */
+    IMU_DROP_MISSED_EDGE,       /**< Data-ready edge never handled (task late). */
+    IMU_DROP_FIFO_OVERRUN,      /**< Sensor FIFO overflowed (FIFO mode). */
+    IMU_DROP_SOURCE_COUNT
+} imu_drop_source_t;
+
+/**
+ * @brief Dropped-sample accounting.
+ */
+typedef struct imu_drop_stats_t {
+    uint32_t produced;                          /**< Sequence numbers issued (samples produced by the sensor). */
+    uint32_t dropped[IMU_DROP_SOURCE_COUNT];    /**< Lost samples per source. */
+} imu_drop_stats_t;
+
+/**
+ * @brief Timing statistics of the data-ready edges.
+ *
+ * Interval and jitter are measured between consecutive interrupt timestamps;
+ * read delay is the time from the edge until the sample was read.
+ */
+typedef struct imu_timing_stats_t {
+    uint32_t samples;           /**< Timestamped samples in the window. */
+    uint32_t interval_min_us;   /**< Shortest edge-to-edge interval. */
+    uint32_t interval_max_us;   /**< Longest edge-to-edge interval. */
+    uint32_t jitter_avg_us;     /**< Average |interval - nominal period|. */
+    uint32_t jitter_max_us;     /**< Largest |interval - nominal period|. */
+    uint32_t read_delay_avg_us; /**< Average edge-to-read delay. */
+    uint32_t read_delay_max_us; /**< Largest edge-to-read delay. */
+    uint32_t missed_edges;      /**< Edges never handled (intervals rounded to whole periods). */
+} imu_timing_stats_t;
+
+/**
+ * @brief Global mailbox for IMU samples (statically allocated, published by imu_task()).
  *
  * Producer: imu_task() pushes new samples.
  * Consumers: fft_task() (and others) pop samples and must free them.
  */
-extern Mail<imu_data_t, 10> *imu_mail_box;
+extern Mail<imu_data_t, IMU_MAILBOX_DEPTH> *imu_mail_box;
 
 /**
  * @brief RTOS task entry: wait for IMU data-ready and publish samples.
  */
 void imu_task();
+
+/**
+ * @brief Read and reset the data-ready timing statistics.
+ * @param stats Output statistics since the last call.
+ */
+void imu_timing_get_and_reset(imu_timing_stats_t *stats);
+
+/**
+ * @brief Read and reset the dropped-sample counters.
+ * @param stats Output counters since the last call.
+ */
+void imu_drops_get_and_reset(imu_drop_stats_t *stats);
+
+/**
+ * @brief Short name of a drop source for reports.
+ */
+const char *imu_drop_source_name(imu_drop_source_t source);
+
+/**
+ * @brief Timestamp and read one raw IMU sample (gyro + accel).
+ *
+ * Shared by the threaded task and the single-thread pipeline. Call once per
+ * data-ready edge: it also assigns the sequence number.
+ *
+ * @param sample Output sample.
+ * @param edge_us Time of the edge, captured in interrupt context
+ *                (imu_data_ready_time_us() when handled before the next edge).
+ * @return true on success, false if an I2C read failed.
+ */
+bool imu_sample_read(imu_data_t *sample, uint32_t edge_us);
+
+/**
+ * @brief Note a data-ready edge that was dropped before imu_sample_read().
+ *
+ * For the single-thread pipeline, whose event queue stands in for the
+ * mailbox: the edge is counted as IMU_DROP_MAILBOX_FULL when the next handled
+ * edge reveals the gap, instead of as IMU_DROP_MISSED_EDGE. ISR-safe.
+ */
+void imu_edge_unqueued();
@@ -5,7 +5,31 @@
  * @brief RTOS task for LED status indication.
  */
 
+#include "mbed.h"
+#include "ram_budget.hpp"
+
+/**
+ * @brief Period of the LED animation tick.
+ */
+#define LED_TICK_PERIOD 50ms
+
+/**
+ * @brief Execution budget of one LED step (us).
+ */
+#define LED_TASK_BUDGET_US 1000
+
+/**
+ * @brief Stack size of led_task (bytes).
+ */
+#define LED_TASK_STACK_SIZE TASK_STACK_SIZE_DEFAULT
+
 /**
  * @brief RTOS task entry: drive LEDs based on system status.
  */
 void led_task();
+
+/**
+ * @brief Render the current status and advance the animation if a tick is due.
+ * @return Time remaining until the next animation tick.
+ */
+Kernel::Clock::duration led_step();
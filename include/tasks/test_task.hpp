@@ -5,7 +5,48 @@
  * @brief Low-priority diagnostic task (CPU/thread statistics).
  */
 
+#include "ram_budget.hpp"
+
+/**
+ * @brief Reporting period of the diagnostics (ms).
+ */
+#define SAMPLE_TIME_MS 2000
+
+/**
+ * @brief Stack size of test_task (bytes).
+ */
+#define TEST_TASK_STACK_SIZE TASK_STACK_SIZE_DEFAULT
+
+/**
+ * @brief Share of each thread's stack (percent) that must stay unused.
+ *
+ * test_report() logs every new per-thread stack peak (high-water mark from
+ * mbed_stats_thread_get_each()) and warns when a peak leaves less than this
+ * free. See TASK_STACK_SIZE_DEFAULT for how a stack is shrunk.
+ */
+#define TEST_STACK_MARGIN_PCT 25
+
+/**
+ * @brief Maximum number of threads listed in one report.
+ */
+#define TEST_MAX_THREADS 8
+
+/**
+ * @brief RAM of the per-thread statistics table (mbed_stats.h).
+ */
+#define TEST_THREAD_STATS_BYTES (TEST_MAX_THREADS * sizeof(mbed_stats_thread_t))
+
 /**
  * @brief RTOS task entry: periodically print system statistics.
  */
 void test_task();
+
+/**
+ * @brief Take the initial CPU idle sample and run the enabled start-up benches.
+ */
+void test_init();
+
+/**
+ * @brief Print one diagnostics report (expected every SAMPLE_TIME_MS).
+ */
+void test_report();
@@ -0,0 +1,118 @@
+#pragma once
+
+/**
+ * @file trace.hpp
+ * @brief In-RAM ring of fixed-size trace events (build option TRACE_BUFFER).
+ *
+ * Each event is 8 bytes: a profile_counter_now() timestamp, an event type and
+ * a 16-bit argument. Recording claims a slot with one atomic increment and
+ * stores two words, so probes can sit on the hot path and in interrupts. The
+ * ring overwrites its oldest events and always holds the last TRACE_EVENTS.
+ *
+ * Recorded events:
+ *   - thread switches (RTX EvrRtxThreadSwitched hook, argument = thread index)
+ *   - stage begin/end from every PROFILE_SCOPE (argument = profile_stage_t)
+ *   - IMU mailbox put/get (argument = low 16 bits of the sample sequence)
+ *   - IMU sample drops (argument = imu_drop_source_t)
+ *   - result buffer trylock failures (argument = buffer index)
+ *
+ * Sending TRACE_DUMP_COMMAND on the serial console dumps the ring as text
+ * lines starting with "TRACE"; scripts/trace_to_chrome.py turns a capture
+ * into Chrome/Perfetto trace JSON.
+ *
+ * Without TRACE_BUFFER, trace_record() and the other calls compile to nothing.
+ */
+
+#include <stdint.h>
+#include "profile_counter.hpp"
+
+/**
+ * @brief Number of events kept in the ring (power of two).
+ */
+#define TRACE_EVENTS 512
+
+/**
+ * @brief Number of distinct threads the switch hook can index.
+ */
+#define TRACE_MAX_THREADS 16
+
+/**
+ * @brief Serial console character that requests a dump.
+ */
+#define TRACE_DUMP_COMMAND 'T'
+
+/**
+ * @brief Event types (stored in 16 bits).
+ */
+typedef enum {
+    TRACE_THREAD_SWITCH = 0,    /**< Scheduler switched to thread `arg`. */
+    TRACE_STAGE_BEGIN,          /**< Stage `arg` started on the running thread. */
+    TRACE_STAGE_END,            /**< Stage `arg` ended on the running thread. */
+    TRACE_MAIL_PUT,             /**< Sample `arg` (sequence) put into the IMU mailbox. */
+    TRACE_MAIL_GET,             /**< Sample `arg` (sequence) taken from the IMU mailbox. */
+    TRACE_IMU_DROP,             /**< Sample lost, `arg` = imu_drop_source_t. */
+    TRACE_TRYLOCK_FAIL,         /**< fft_results[`arg`] mutex was busy. */
+    TRACE_TYPE_COUNT
+} trace_type_t;
+
+#ifdef TRACE_BUFFER
+#include <atomic>
+
+/**
+ * @brief One trace event.
+ */
+typedef struct trace_event_t {
+    uint32_t time;  /**< profile_counter_now() at the event. */
+    uint16_t type;  /**< trace_type_t. */
+    uint16_t arg;   /**< Type-specific argument. */
+} trace_event_t;
+
+static_assert((TRACE_EVENTS & (TRACE_EVENTS - 1)) == 0, "TRACE_EVENTS must be a power of two");
+static_assert(sizeof(trace_event_t) == 8, "trace events must stay 8 bytes");
+
+extern trace_event_t g_trace_ring[TRACE_EVENTS];
+extern std::atomic<uint32_t> g_trace_head;
+extern std::atomic<bool> g_trace_enabled;
+
+/**
+ * @brief Enable the counter and start recording (call once at start-up).
+ */
+void trace_init();
+
+/**
+ * @brief Record one event (thread or interrupt context).
+ * @param type Event type.
+ * @param arg Type-specific argument (truncated to 16 bits).
+ */
+static inline void trace_record(trace_type_t type, uint32_t arg) {
+    if (!g_trace_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    trace_event_t *event = &g_trace_ring[g_trace_head.fetch_add(1, std::memory_order_relaxed) & (TRACE_EVENTS - 1)];
+    event->time = profile_counter_now();
+    event->type = (uint16_t)type;
+    event->arg = (uint16_t)arg;
+}
+
+/**
+ * @brief Dump the ring over serial and restart recording.
+ *
+ * Recording pauses for the dump, which holds the serial lock and takes about
+ * a second at 115200 baud. Call from thread context.
+ */
+void trace_dump();
+
+/**
+ * @brief Dump the ring if TRACE_DUMP_COMMAND arrived on the serial console.
+ *
+ * Called with every test report. The first call also warns if no thread
+ * switch has been recorded, i.e. the RTX configuration compiles the
+ * EvrRtxThreadSwitched hook out.
+ */
+void trace_poll_command();
+#else
+static inline void trace_init() {}
+static inline void trace_record(trace_type_t, uint32_t) {}
+static inline void trace_dump() {}
+static inline void trace_poll_command() {}
+#endif
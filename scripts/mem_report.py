@@ -0,0 +1,153 @@
+"""
+PlatformIO post script: memory placement and map report.
+
+- Writes a linker map next to the firmware (firmware.map).
+- With -DMEM_PLACEMENT, puts scripts/mem_placement.ld ahead of the Mbed
+  target script. It must come first so its input-section patterns win.
+- After linking, writes mem_report.txt to the build directory and prints it.
+  The report lists the size of each allocated section per memory region
+  (FLASH, SRAM1, SRAM2), the address and region of the hot FFT data and
+  DSP kernels, and the RAM budget: linked size of every task stack, DSP
+  buffer, queue and result ring (see include/ram_budget.hpp).
+"""
+
+import os
+import subprocess
+
+Import("env")  # noqa: F821  (provided by SCons)
+
+# Symbols whose placement the report tracks.
+HOT_SYMBOLS = [
+    "fft_input",
+    "fft_output",
+    "fft_results",
+    "sensor_data_buffer",
+    "fft_int16_to_float",
+    "fft_load_window",
+    "fft_axis_spectrum",
+    "fft_compute",
+    "arm_rfft_fast_f32",
+    "stage_rfft_f32",
+    "arm_cfft_f32",
+    "arm_cfft_radix8by4_f32",
+    "arm_radix8_butterfly_f32",
+    "arm_bitreversal_32",
+    "arm_cmplx_mag_f32",
+    "arm_mult_f32",
+    "arm_scale_f32",
+]
+
+# Statically allocated objects of the RAM budget, by category. Objects not
+# present in a build mode are skipped.
+BUDGET_SYMBOLS = [
+    ("stack", ["imu_stack", "fft_stack", "analysis_stack", "led_stack", "ble_stack", "test_stack", "pipeline_stack",
+               "log_drain_stack"]),
+    ("dsp", ["sensor_data_buffer", "fft_input", "fft_output", "fft_handler", "fft_handler_small"]),
+    ("queue", ["imu_mail_box_storage", "pipeline_queue_buffer", "ble_own_queue_buffer", "frame_pool", "log_ring",
+               "g_trace_ring"]),
+    ("result", ["fft_results", "motion_status_traces"]),
+    ("diag", ["thread_stats", "latency_stats", "profile_stats"]),
+    ("bench", ["bench_c_storage", "bench_typed", "bench_axes", "bench_multi"]),
+]
+
+# STM32L475xG address map.
+REGIONS = [
+    ("FLASH", 0x08000000, 0x08100000),
+    ("SRAM2", 0x10000000, 0x10008000),
+    ("SRAM1", 0x20000000, 0x20018000),
+]
+
+
+def _has_define(name):
+    for define in env.get("CPPDEFINES", []):
+        if define == name or (isinstance(define, (list, tuple)) and define[0] == name):
+            return True
+    return False
+
+
+def _region(address):
+    for region, start, end in REGIONS:
+        if start <= address < end:
+            return region
+    return "-"
+
+
+def _tool(name):
+    # arm-none-eabi-gcc -> arm-none-eabi-<name>
+    cc = env.subst("$CC")
+    return cc[: -len("gcc")] + name if cc.endswith("gcc") else name
+
+
+def _sections(elf):
+    # objdump -h: idx name size vma lma offset align, then a flags line.
+    out = subprocess.check_output([_tool("objdump"), "-h", elf], universal_newlines=True)
+    lines = out.splitlines()
+    sections = []
+    for i, line in enumerate(lines):
+        fields = line.split()
+        if len(fields) == 7 and fields[0].isdigit():
+            flags = lines[i + 1] if i + 1 < len(lines) else ""
+            if "ALLOC" in flags:
+                sections.append((fields[1], int(fields[2], 16), int(fields[3], 16), int(fields[4], 16)))
+    return sections
+
+
+def _symbols(elf):
+    # Demangled, keyed by the name without its parameter list.
+    out = subprocess.check_output([_tool("nm"), "-S", "-C", elf], universal_newlines=True)
+    symbols = {}
+    for line in out.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) == 4:
+            symbols[fields[3].split("(")[0]] = (int(fields[0], 16), int(fields[1], 16))
+    return symbols
+
+
+def mem_report(source, target, env):
+    elf = str(target[0])
+    sections = _sections(elf)
+    symbols = _symbols(elf)
+
+    lines = ["Memory placement report (%s)" % ("MEM_PLACEMENT" if _has_define("MEM_PLACEMENT") else "default"), ""]
+    lines.append("%-20s %8s  %-10s %-6s %-10s %-6s" % ("section", "size", "vma", "region", "lma", "region"))
+    totals = {}
+    for name, size, vma, lma in sections:
+        lines.append("%-20s %8d  0x%08x %-6s 0x%08x %-6s" % (name, size, vma, _region(vma), lma, _region(lma)))
+        totals[_region(vma)] = totals.get(_region(vma), 0) + size
+        if lma != vma:
+            totals[_region(lma)] = totals.get(_region(lma), 0) + size
+    lines.append("")
+    for region, start, end in REGIONS:
+        lines.append("%-6s %8d of %8d bytes" % (region, totals.get(region, 0), end - start))
+    lines.append("")
+    lines.append("%-28s %8s  %-10s %-6s" % ("hot symbol", "size", "address", "region"))
+    for name in HOT_SYMBOLS:
+        if name in symbols:
+            address, size = symbols[name]
+            lines.append("%-28s %8d  0x%08x %-6s" % (name, size, address, _region(address & ~1)))
+        else:
+            lines.append("%-28s %8s  %-10s %-6s" % (name, "-", "-", "(not linked)"))
+    lines.append("")
+    lines.append("%-8s %-24s %8s  %-6s" % ("budget", "object", "size", "region"))
+    budget_total = 0
+    for category, names in BUDGET_SYMBOLS:
+        category_total = 0
+        for name in names:
+            if name in symbols:
+                address, size = symbols[name]
+                lines.append("%-8s %-24s %8d  %-6s" % (category, name, size, _region(address)))
+                category_total += size
+        lines.append("%-8s %-24s %8d" % (category, "(total)", category_total))
+        budget_total += category_total
+    lines.append("%-8s %-24s %8d" % ("all", "(total)", budget_total))
+
+    report = "\n".join(lines) + "\n"
+    with open(os.path.join(env.subst("$BUILD_DIR"), "mem_report.txt"), "w") as f:
+        f.write(report)
+    print(report)
+
+
+if _has_define("MEM_PLACEMENT"):
+    env.Prepend(LINKFLAGS=["-T", os.path.join(env.subst("$PROJECT_DIR"), "scripts", "mem_placement.ld")])
+env.Append(LINKFLAGS=["-Wl,-Map," + os.path.join(env.subst("$BUILD_DIR"), "firmware.map")])
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", mem_report)
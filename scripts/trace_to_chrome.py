@@ -0,0 +1,173 @@
+"""
+Convert a trace dump from the serial console to Chrome/Perfetto trace JSON.
+
+Build with -DTRACE_BUFFER, capture the console to a file (for example with
+`pio device monitor --quiet > capture.log`), send 'T', then run
+
+    python scripts/trace_to_chrome.py capture.log trace.json
+
+and open trace.json in https://ui.perfetto.dev or chrome://tracing. Lines not
+starting with "TRACE" are ignored; the last complete dump in the capture is
+used (see include/trace.hpp for the event types).
+
+Timeline layout:
+- "cpu" track: one slice per scheduled thread, from thread switch events.
+- One track per thread: stage slices from PROFILE_SCOPE begin/end, plus
+  instants for mailbox put/get, sample drops and trylock failures. Events
+  before the first thread switch go to the "unknown" track.
+- "imu_mail_box" counter: puts minus gets, shifted so the minimum is zero.
+"""
+
+import json
+import sys
+
+# Mirrors trace_type_t in include/trace.hpp.
+THREAD_SWITCH = 0
+STAGE_BEGIN = 1
+STAGE_END = 2
+MAIL_PUT = 3
+MAIL_GET = 4
+IMU_DROP = 5
+TRYLOCK_FAIL = 6
+
+PID = 1
+CPU_TID = 1000
+UNKNOWN_TID = 1001
+
+
+def parse_dump(lines):
+    """Return the last complete dump as a dict, or None."""
+    dump = None
+    last = None
+    for line in lines:
+        start = line.find("TRACE ")
+        if start < 0:
+            continue
+        fields = line[start:].split(maxsplit=3)
+        tag = fields[1]
+        if tag == "BEGIN":
+            dump = {"hz": int(fields[2]), "threads": {}, "stages": {}, "drops": {}, "events": []}
+        elif dump is None:
+            continue
+        elif tag in ("THREAD", "STAGE", "DROP"):
+            table = {"THREAD": "threads", "STAGE": "stages", "DROP": "drops"}[tag]
+            dump[table][int(fields[2])] = fields[3].strip() if len(fields) > 3 else "?"
+        elif tag == "E":
+            rest = line[start:].split()
+            dump["events"].append((int(rest[2], 16), int(rest[3]), int(rest[4])))
+        elif tag == "END":
+            last = dump
+            dump = None
+    return last
+
+
+def unwrap(events, hz):
+    """Yield (microseconds, type, arg) with the 32-bit counter unwrapped.
+
+    Deltas are taken as signed, so counter wraps (gaps < 2^31 ticks) and the
+    small reorderings of probes interrupted mid-record are both handled.
+    """
+    if not events:
+        return
+    base = events[0][0]
+    elapsed = 0
+    previous = base
+    for time, event_type, arg in events:
+        delta = (time - previous) & 0xFFFFFFFF
+        if delta >= 0x80000000:
+            delta -= 0x100000000
+        elapsed += delta
+        previous = time
+        yield elapsed * 1e6 / hz, event_type, arg
+
+
+def convert(dump):
+    out = []
+
+    def meta(tid, name):
+        out.append({"ph": "M", "name": "thread_name", "pid": PID, "tid": tid, "args": {"name": name}})
+
+    meta(CPU_TID, "cpu")
+    meta(UNKNOWN_TID, "unknown")
+    for index, name in sorted(dump["threads"].items()):
+        meta(index, name)
+
+    def thread_name(index):
+        return dump["threads"].get(index, "thread%d" % index)
+
+    current = UNKNOWN_TID
+    running_since = None
+    open_stages = {}
+    depth = 0
+    depth_samples = []
+    ts = 0.0
+
+    for ts, event_type, arg in unwrap(dump["events"], dump["hz"]):
+        if event_type == THREAD_SWITCH:
+            if running_since is not None and current != UNKNOWN_TID:
+                out.append({"ph": "X", "name": thread_name(current), "pid": PID, "tid": CPU_TID,
+                            "ts": running_since, "dur": ts - running_since})
+            current = arg
+            running_since = ts
+        elif event_type in (STAGE_BEGIN, STAGE_END):
+            name = dump["stages"].get(arg, "stage%d" % arg)
+            stack = open_stages.setdefault(current, [])
+            if event_type == STAGE_BEGIN:
+                stack.append(name)
+                out.append({"ph": "B", "name": name, "pid": PID, "tid": current, "ts": ts})
+            elif name in stack:
+                # Ends without a begin (ring start) are dropped to keep nesting valid.
+                while stack and stack[-1] != name:
+                    out.append({"ph": "E", "pid": PID, "tid": current, "ts": ts})
+                    stack.pop()
+                stack.pop()
+                out.append({"ph": "E", "pid": PID, "tid": current, "ts": ts})
+        elif event_type in (MAIL_PUT, MAIL_GET):
+            depth += 1 if event_type == MAIL_PUT else -1
+            depth_samples.append((ts, depth))
+            out.append({"ph": "i", "s": "t", "name": "mail put" if event_type == MAIL_PUT else "mail get",
+                        "pid": PID, "tid": current, "ts": ts, "args": {"seq": arg}})
+        elif event_type == IMU_DROP:
+            out.append({"ph": "i", "s": "t", "name": "imu drop", "pid": PID, "tid": current, "ts": ts,
+                        "args": {"source": dump["drops"].get(arg, str(arg))}})
+        elif event_type == TRYLOCK_FAIL:
+            out.append({"ph": "i", "s": "t", "name": "trylock fail", "pid": PID, "tid": current, "ts": ts,
+                        "args": {"lock": "fft_results[%d]" % arg}})
+
+    # Close what is still open at the end of the ring.
+    if running_since is not None and current != UNKNOWN_TID:
+        out.append({"ph": "X", "name": thread_name(current), "pid": PID, "tid": CPU_TID,
+                    "ts": running_since, "dur": ts - running_since})
+    for tid, stack in open_stages.items():
+        for _ in stack:
+            out.append({"ph": "E", "pid": PID, "tid": tid, "ts": ts})
+
+    if depth_samples:
+        floor = min(d for _, d in depth_samples)
+        for sample_ts, d in depth_samples:
+            out.append({"ph": "C", "name": "imu_mail_box", "pid": PID, "ts": sample_ts, "args": {"depth": d - floor}})
+
+    return {"traceEvents": out, "displayTimeUnit": "ns"}
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write("usage: trace_to_chrome.py CAPTURE [OUTPUT.json]\n")
+        return 2
+    with open(argv[1], errors="replace") as capture:
+        dump = parse_dump(capture)
+    if dump is None:
+        sys.stderr.write("no complete TRACE BEGIN ... TRACE END block found\n")
+        return 1
+    trace = convert(dump)
+    if len(argv) == 3:
+        with open(argv[2], "w") as output:
+            json.dump(trace, output)
+    else:
+        json.dump(trace, sys.stdout)
+    sys.stderr.write("%d events, %d threads\n" % (len(dump["events"]), len(dump["threads"])))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
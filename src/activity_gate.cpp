@@ -0,0 +1,139 @@
+/**
+ * @file activity_gate.cpp
+ * @brief Implementation of the hardware activity gate.
+ */
+
+#ifdef IMU_ACTIVITY_GATING
+
+#define LOG_MODULE LOG_MODULE_IMU
+
+#include "activity_gate.hpp"
+#include "mbed.h"
+#include <atomic>
+#include <inttypes.h>
+#include "logger.hpp"
+#include "bsp/imu.hpp"
+
+static std::atomic<bool> activity_gate_state(true);
+static std::atomic<uint32_t> activity_gate_openings(0);
+static EventFlags activity_gate_flags;
+static uint32_t activity_gate_last_poll_us = 0;
+
+// Gated time accounting, shared by imu_task and the report.
+static Mutex activity_gate_time_mutex;
+static Kernel::Clock::time_point activity_gate_closed_at;
+static Kernel::Clock::time_point activity_gate_window_start;
+static Kernel::Clock::duration activity_gate_closed_time(0);
+static uint32_t activity_gate_window_closures = 0;
+
+// Start of the current pause, clipped to the report window.
+static Kernel::Clock::time_point activity_gate_pause_start() {
+    return activity_gate_closed_at > activity_gate_window_start ? activity_gate_closed_at : activity_gate_window_start;
+}
+
+void activity_gate_close() {
+    activity_gate_time_mutex.lock();
+    activity_gate_closed_at = Kernel::Clock::now();
+    activity_gate_window_closures++;
+    activity_gate_time_mutex.unlock();
+
+    activity_gate_state.store(false);
+}
+
+void activity_gate_open() {
+    activity_gate_time_mutex.lock();
+    activity_gate_closed_time += Kernel::Clock::now() - activity_gate_pause_start();
+    activity_gate_time_mutex.unlock();
+
+    activity_gate_openings++;
+    activity_gate_state.store(true);
+    activity_gate_flags.set(ACTIVITY_GATE_WAITER_FFT | ACTIVITY_GATE_WAITER_ANALYSIS);
+}
+
+bool activity_gate_is_open() {
+    return activity_gate_state.load();
+}
+
+void activity_gate_wait_open(uint32_t waiter) {
+    // A stale bit from an earlier opening only costs one extra loop.
+    while (!activity_gate_state.load()) {
+        activity_gate_flags.wait_any(waiter);
+    }
+}
+
+// Always while closed; while open, every ACTIVITY_GATE_POLL_US of edge time.
+static bool activity_gate_poll_due(uint32_t edge_us) {
+    // Unsigned subtraction handles ticker wrap-around.
+    if (activity_gate_state.load() && edge_us - activity_gate_last_poll_us < ACTIVITY_GATE_POLL_US) {
+        return false;
+    }
+    activity_gate_last_poll_us = edge_us;
+    return true;
+}
+
+activity_gate_edge_t activity_gate_step(uint32_t edge_us) {
+    bool open = activity_gate_state.load();
+    activity_gate_edge_t unchanged = open ? ACTIVITY_GATE_EDGE_PUBLISH : ACTIVITY_GATE_EDGE_CONSUMED;
+    if (!activity_gate_poll_due(edge_us)) {
+        return unchanged;
+    }
+
+#if DEVICE_I2C_ASYNCH
+    if (imu_read_async_busy()) {
+        return unchanged;
+    }
+#endif
+    int sleeping = imu_activity_sleeping();
+    if (sleeping < 0) {
+        LOG_WARN("Failed to read IMU activity state");
+        return unchanged;
+    }
+
+    if (open && sleeping == 1) {
+        activity_gate_close();
+        LOG_INFO("IMU inactive: DSP gated off");
+        return ACTIVITY_GATE_EDGE_CONSUMED;
+    }
+    if (!open && sleeping == 0) {
+        activity_gate_open();
+        LOG_INFO("IMU active: DSP resumed");
+        return ACTIVITY_GATE_EDGE_OPENED;
+    }
+    return unchanged;
+}
+
+uint32_t activity_gate_epoch() {
+    return activity_gate_openings.load();
+}
+
+void activity_gate_get_and_reset(activity_gate_stats_t *stats) {
+    bool open = activity_gate_is_open();
+
+    activity_gate_time_mutex.lock();
+    Kernel::Clock::time_point now = Kernel::Clock::now();
+    Kernel::Clock::duration closed_time = activity_gate_closed_time;
+    if (!open) {
+        closed_time += now - activity_gate_pause_start();
+    }
+    Kernel::Clock::duration window = now - activity_gate_window_start;
+    uint32_t closures = activity_gate_window_closures;
+    activity_gate_window_start = now;
+    activity_gate_closed_time = Kernel::Clock::duration(0);
+    activity_gate_window_closures = 0;
+    activity_gate_time_mutex.unlock();
+
+    stats->open = open;
+    stats->period_ms = (uint32_t)window.count();
+    stats->gated_ms = (uint32_t)closed_time.count();
+    stats->gated_pct = window.count() > 0 ? (uint32_t)(closed_time.count() * 100 / window.count()) : 0;
+    stats->closures = closures;
+}
+
+void activity_gate_report() {
+    activity_gate_stats_t stats;
+    activity_gate_get_and_reset(&stats);
+    LOG_INFO("Activity gate: %s | DSP gated off %" PRIu32 "%% of last period | closures %" PRIu32,
+        stats.open ? "open" : "closed", stats.gated_pct, stats.closures);
+}
+
+#endif // IMU_ACTIVITY_GATING
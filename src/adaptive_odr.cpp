@@ -0,0 +1,126 @@
+/**
+ * @file adaptive_odr.cpp
+ * @brief Implementation of the motion-adaptive IMU output data rate.
+ */
+
+#ifdef IMU_ADAPTIVE_ODR
+
+#define LOG_MODULE LOG_MODULE_IMU
+
+#include "adaptive_odr.hpp"
+#include "mbed.h"
+#include <atomic>
+#include <inttypes.h>
+#include "logger.hpp"
+
+static const char *adaptive_odr_state_names[] = {
+    "ACTIVE",
+    "REST_PENDING",
+    "REST"
+};
+
+static std::atomic<uint32_t> adaptive_odr_state(ADAPTIVE_ODR_ACTIVE);
+static std::atomic<uint32_t> adaptive_odr_wakeups(0);
+
+// Analysis side: quiet-frame counter.
+static uint32_t adaptive_odr_quiet_frames = 0;
+static uint32_t adaptive_odr_last_frame_us = 0;
+
+// imu_task side: previous rest sample for the accel change test.
+static float32_t adaptive_odr_rest_accel[3];
+static bool adaptive_odr_have_rest_accel = false;
+
+// Rest time accounting, shared by imu_task and the report.
+static Mutex adaptive_odr_time_mutex;
+static Kernel::Clock::time_point adaptive_odr_rest_start;
+static Kernel::Clock::time_point adaptive_odr_window_start;
+static Kernel::Clock::duration adaptive_odr_rest_time(0);
+static uint32_t adaptive_odr_window_wakeups = 0;
+
+void adaptive_odr_frame(float32_t band_power, uint32_t frame_time_us) {
+    if (adaptive_odr_state.load() != ADAPTIVE_ODR_ACTIVE || frame_time_us == adaptive_odr_last_frame_us) {
+        return;
+    }
+    adaptive_odr_last_frame_us = frame_time_us;
+
+    if (band_power >= ADAPTIVE_ODR_REST_POWER) {
+        adaptive_odr_quiet_frames = 0;
+        return;
+    }
+    if (++adaptive_odr_quiet_frames >= ADAPTIVE_ODR_REST_FRAMES) {
+        adaptive_odr_quiet_frames = 0;
+        adaptive_odr_state.store(ADAPTIVE_ODR_REST_PENDING);
+    }
+}
+
+adaptive_odr_state_t adaptive_odr_get_state() {
+    return (adaptive_odr_state_t)adaptive_odr_state.load();
+}
+
+void adaptive_odr_enter_rest() {
+    adaptive_odr_have_rest_accel = false;
+
+    adaptive_odr_time_mutex.lock();
+    adaptive_odr_rest_start = Kernel::Clock::now();
+    adaptive_odr_time_mutex.unlock();
+
+    adaptive_odr_state.store(ADAPTIVE_ODR_REST);
+}
+
+bool adaptive_odr_check_motion(const float32_t *accel, const float32_t *gyro) {
+    bool moved = false;
+    for (int i = 0; i < 3; i++) {
+        if (fabsf(gyro[i]) > ADAPTIVE_ODR_WAKE_GYRO) {
+            moved = true;
+        }
+        if (adaptive_odr_have_rest_accel && fabsf(accel[i] - adaptive_odr_rest_accel[i]) > ADAPTIVE_ODR_WAKE_ACCEL) {
+            moved = true;
+        }
+        adaptive_odr_rest_accel[i] = accel[i];
+    }
+    adaptive_odr_have_rest_accel = true;
+    return moved;
+}
+
+void adaptive_odr_wake() {
+    adaptive_odr_time_mutex.lock();
+    Kernel::Clock::time_point now = Kernel::Clock::now();
+    // Only the part of the pause inside the current report window counts.
+    Kernel::Clock::time_point from = adaptive_odr_rest_start > adaptive_odr_window_start ? adaptive_odr_rest_start : adaptive_odr_window_start;
+    adaptive_odr_rest_time += now - from;
+    adaptive_odr_window_wakeups++;
+    adaptive_odr_time_mutex.unlock();
+
+    // imu_task publishes the first full-rate sample only after this returns,
+    // so fft_task always sees the new epoch with it.
+    adaptive_odr_wakeups++;
+    adaptive_odr_state.store(ADAPTIVE_ODR_ACTIVE);
+}
+
+uint32_t adaptive_odr_epoch() {
+    return adaptive_odr_wakeups.load();
+}
+
+void adaptive_odr_report() {
+    adaptive_odr_state_t state = adaptive_odr_get_state();
+
+    adaptive_odr_time_mutex.lock();
+    Kernel::Clock::time_point now = Kernel::Clock::now();
+    Kernel::Clock::duration rest_time = adaptive_odr_rest_time;
+    if (state == ADAPTIVE_ODR_REST) {
+        Kernel::Clock::time_point from = adaptive_odr_rest_start > adaptive_odr_window_start ? adaptive_odr_rest_start : adaptive_odr_window_start;
+        rest_time += now - from;
+    }
+    Kernel::Clock::duration window = now - adaptive_odr_window_start;
+    uint32_t wakeups = adaptive_odr_window_wakeups;
+    adaptive_odr_window_start = now;
+    adaptive_odr_rest_time = Kernel::Clock::duration(0);
+    adaptive_odr_window_wakeups = 0;
+    adaptive_odr_time_mutex.unlock();
+
+    uint32_t rest_pct = window.count() > 0 ? (uint32_t)(rest_time.count() * 100 / window.count()) : 0;
+    LOG_INFO("Adaptive ODR: %s | rest %" PRIu32 "%% of last period | wakeups %" PRIu32,
+        adaptive_odr_state_names[state], rest_pct, wakeups);
+}
+
+#endif // IMU_ADAPTIVE_ODR
@@ -5,10 +5,19 @@
 
 #include "bsp/imu.hpp"
 #include "mbed.h"
+#include "hal/us_ticker_api.h"
+#include "static_storage.hpp"
+#include "profiler.hpp"
+
+static static_storage<I2C> imu_i2c_storage;
+static static_storage<InterruptIn> imu_int1_pin_storage;
+static EventFlags imu_data_ready_flag_storage;
 
 I2C *imu_i2c = nullptr;
 InterruptIn *imu_int1_pin = nullptr;
 EventFlags *imu_data_ready_flag = nullptr;
+Callback<void()> imu_data_ready_handler = nullptr;
+volatile uint32_t imu_data_ready_us = 0;
 
 // Write a single byte to a register.
 bool imu_write_reg(uint8_t reg, uint8_t val) {
@@ -31,53 +40,148 @@ bool imu_read_reg(uint8_t reg, uint8_t &val) {
     return true;
 }
 
-// Read a 16-bit signed integer from two consecutive registers.
-bool imu_read_int16(uint8_t reg_low, int16_t &val) {
-    uint8_t lo, hi;
-    // Read low byte
-    if (!imu_read_reg(reg_low, lo)) return false;
-    // Read high byte from next register
-    if (!imu_read_reg(reg_low + 1, hi)) return false;
-    // Combine bytes into 16-bit value (little-endian)
-    val = (int16_t)((hi << 8) | lo);
+// Read `len` consecutive registers starting at `reg` (needs IF_INC in CTRL3_C).
+bool imu_read_regs(uint8_t reg, uint8_t *buf, int len) {
+    char r = (char)reg;
+    // Write start address with repeated start, then read the whole block.
+    if (imu_i2c->write(LSM6DSL_ADDR, &r, 1, true) != 0) return false;
+    if (imu_i2c->read(LSM6DSL_ADDR, (char*)buf, len) != 0) return false;
     return true;
 }
 
-bool imu_read_acc_data(float32_t* acc) {
-    int16_t acc_raw;
-    // Read X, Y, Z axes in order (registers are consecutive every 2 bytes).
-    for (int i = 0; i < 3; i++) {
-        if (!imu_read_int16(OUTX_L_XL + i*2, acc_raw)) return false;
-        acc[i] = (float32_t)acc_raw * ACC_SENSITIVITY;
+bool imu_read_raw(int16_t* raw) {
+    PROFILE_SCOPE(PROFILE_STAGE_IMU_READ_RAW);
+    uint8_t buf[IMU_BURST_LEN];
+    if (!imu_read_regs(OUTX_L_G, buf, IMU_BURST_LEN)) return false;
+    // Gyro X/Y/Z then accel X/Y/Z, little-endian pairs.
+    for (int i = 0; i < 6; i++) {
+        raw[i] = (int16_t)((buf[i*2 + 1] << 8) | buf[i*2]);
     }
     return true;
 }
 
-bool imu_read_gyro_data(float32_t* gyro) {
-    int16_t gyro_raw;
-    // Read X, Y, Z axes in order (registers are consecutive every 2 bytes).
+#if DEVICE_I2C_ASYNCH
+static const char imu_async_reg = OUTX_L_G;
+static Callback<void(bool)> imu_async_done = nullptr;
+static volatile bool imu_async_active = false;
+
+// I2C transfer event (interrupt context).
+static void imu_async_event(int event) {
+    imu_async_active = false;
+    bool ok = (event & I2C_EVENT_TRANSFER_COMPLETE) != 0 && (event & I2C_EVENT_ERROR) == 0;
+    if (imu_async_done) {
+        imu_async_done(ok);
+    }
+}
+
+bool imu_read_raw_async(int16_t* raw, Callback<void(bool)> done) {
+    if (imu_async_active) return false;
+    imu_async_done = done;
+    imu_async_active = true;
+    // Address write, repeated start, then the whole block straight into `raw`
+    // (Cortex-M is little-endian like the sensor).
+    if (imu_i2c->transfer(LSM6DSL_ADDR, &imu_async_reg, 1, (char*)raw, IMU_BURST_LEN,
+                          imu_async_event, I2C_EVENT_ALL) != 0) {
+        imu_async_active = false;
+        return false;
+    }
+    return true;
+}
+
+bool imu_read_async_busy() {
+    return imu_async_active;
+}
+#endif
+
+void imu_convert_raw(const int16_t* raw, float32_t* acc, float32_t* gyro) {
     for (int i = 0; i < 3; i++) {
-        if (!imu_read_int16(OUTX_L_G + i*2, gyro_raw)) return false;
-        // Convert to rad/s (datasheet sensitivity -> deg/s -> rad/s).
-        gyro[i] = (float32_t)gyro_raw * GYRO_SENSITIVITY / 360.0f * 2.0f * M_PI;
+        gyro[i] = (float32_t)raw[IMU_RAW_GYRO + i] * IMU_GYRO_SCALE;
+        acc[i] = (float32_t)raw[IMU_RAW_ACCEL + i] * IMU_ACC_SCALE;
     }
+}
+
+bool imu_read_data(float32_t* acc, float32_t* gyro) {
+    int16_t raw[6];
+    if (!imu_read_raw(raw)) return false;
+    imu_convert_raw(raw, acc, gyro);
     return true;
 }
 
+bool imu_fifo_enable(uint16_t watermark_samples) {
+    uint16_t watermark_words = watermark_samples * IMU_FIFO_WORDS_PER_SAMPLE;
+    // Bypass first to flush any old content, then configure and start.
+    if (!imu_write_reg(FIFO_CTRL5, 0x00)) return false;
+    if (!imu_write_reg(FIFO_CTRL1, watermark_words & 0xFF)) return false;
+    if (!imu_write_reg(FIFO_CTRL2, (watermark_words >> 8) & 0x07)) return false;
+    if (!imu_write_reg(FIFO_CTRL3, FIFO_CTRL3_NO_DECIMATION)) return false;
+    if (!imu_write_reg(FIFO_CTRL4, 0x00)) return false;
+    if (!imu_write_reg(FIFO_CTRL5, FIFO_CTRL5_208HZ_CONTINUOUS)) return false;
+    // Watermark replaces data-ready on INT1.
+    return imu_write_reg(INT1_CTRL, INT1_CTRL_FTH);
+}
+
+int imu_fifo_level(bool *overrun) {
+    uint8_t status[4];
+    if (!imu_read_regs(FIFO_STATUS1, status, 4)) return -1;
+
+    uint16_t words = ((status[1] & 0x07) << 8) | status[0];
+    uint16_t pattern = ((status[3] & 0x03) << 8) | status[2];
+    *overrun = (status[1] & FIFO_STATUS2_OVER_RUN) != 0;
+
+    // Pattern is the index of the next word to be read; drop the partial sample.
+    if (pattern != 0 && pattern < IMU_FIFO_WORDS_PER_SAMPLE) {
+        uint16_t skip = IMU_FIFO_WORDS_PER_SAMPLE - pattern;
+        if (skip > words) return 0;
+        uint8_t discard[IMU_FIFO_WORDS_PER_SAMPLE * 2];
+        if (!imu_read_regs(FIFO_DATA_OUT_L, discard, skip * 2)) return -1;
+        words -= skip;
+    }
+    return words / IMU_FIFO_WORDS_PER_SAMPLE;
+}
+
+bool imu_fifo_read(int16_t (*raw)[IMU_FIFO_WORDS_PER_SAMPLE], int count) {
+    // FIFO_DATA_OUT rolls back to its low byte on auto-increment, so one burst
+    // returns consecutive words. Cortex-M is little-endian like the sensor.
+    PROFILE_SCOPE(PROFILE_STAGE_IMU_READ_FIFO);
+    return imu_read_regs(FIFO_DATA_OUT_L, (uint8_t*)raw, count * IMU_FIFO_WORDS_PER_SAMPLE * 2);
+}
+
+bool imu_set_odr(uint8_t ctrl_odr) {
+    if (!imu_write_reg(CTRL1_XL, ctrl_odr)) return false;
+    return imu_write_reg(CTRL2_G, ctrl_odr);
+}
+
+bool imu_activity_enable(uint8_t wake_ths, uint8_t sleep_dur) {
+    if (!imu_write_reg(WAKE_UP_THS, wake_ths & 0x3F)) return false;
+    if (!imu_write_reg(WAKE_UP_DUR, sleep_dur & 0x0F)) return false;
+    return imu_write_reg(TAP_CFG, TAP_CFG_INACT_XL_12HZ5);
+}
+
+int imu_activity_sleeping() {
+    uint8_t src;
+    if (!imu_read_reg(WAKE_UP_SRC, src)) return -1;
+    return (src & WAKE_UP_SRC_SLEEP_STATE) ? 1 : 0;
+}
 
 bool imu_init() {
-    imu_i2c = new I2C(PB_11, PB_10);
+    imu_i2c = imu_i2c_storage.construct(PB_11, PB_10);
     imu_i2c->frequency(400000);
-    imu_int1_pin = new InterruptIn(LSM6DSL_INT1_PIN, PullDown);
-    imu_data_ready_flag = new EventFlags();
-    // Data-ready interrupt: set bit 0 in the flag.
-    imu_int1_pin->rise([] { imu_data_ready_flag->set(1); });
+    imu_int1_pin = imu_int1_pin_storage.construct(LSM6DSL_INT1_PIN, PullDown);
+    imu_data_ready_flag = &imu_data_ready_flag_storage;
+    // Data-ready interrupt: stamp the edge, set bit 0 in the flag and notify
+    // an attached handler.
+    imu_int1_pin->rise([] {
+        imu_data_ready_us = us_ticker_read();
+        imu_data_ready_flag->set(1);
+        if (imu_data_ready_handler) {
+            imu_data_ready_handler();
+        }
+    });
     uint8_t who;
     if (!imu_read_reg(WHO_AM_I, who) || who != 0x6A) return false;
     imu_write_reg(CTRL3_C, 0x44); 
-    imu_write_reg(CTRL1_XL, 0x50); 
-    imu_write_reg(CTRL2_G, 0x50);
-    imu_write_reg(INT1_CTRL, 0x01); 
+    imu_set_odr(CTRL_ODR_208HZ);
+    imu_write_reg(INT1_CTRL, INT1_CTRL_DRDY_XL); 
     imu_write_reg(DRDY_PULSE_CFG, 0x80);
     return true;
 }
@@ -93,3 +197,11 @@ bool imu_data_wait(time_t timeout) {
 void imu_data_ready_clear() {
     imu_data_ready_flag->clear(1);
 }
+
+uint32_t imu_data_ready_time_us() {
+    return imu_data_ready_us;
+}
+
+void imu_data_ready_attach(Callback<void()> cb) {
+    imu_data_ready_handler = cb;
+}
@@ -8,6 +8,13 @@
 
 #include "bsp/led.hpp"
 #include "mbed.h"
+#include "static_storage.hpp"
+
+// Driver objects live in static slots; LED3 swaps between its two slots.
+static static_storage<PwmOut> led_green_1_storage;
+static static_storage<PwmOut> led_green_2_storage;
+static static_storage<PwmOut> led_blue_yellow_out_storage;
+static static_storage<DigitalIn> led_blue_yellow_in_storage;
 
 PwmOut *led_green_1_out = nullptr;
 PwmOut *led_green_2_out = nullptr;
@@ -15,12 +22,12 @@ PwmOut *led_blue_yellow_out = nullptr;
 DigitalIn *led_blue_yellow_in = nullptr;
 
 bool led_init() {
-    led_green_1_out = new PwmOut(LED1);
+    led_green_1_out = led_green_1_storage.construct(LED1);
     led_green_1_out->period_us(100);
-    led_green_2_out = new PwmOut(LED2);
+    led_green_2_out = led_green_2_storage.construct(LED2);
     led_green_2_out->period_us(100);
     // Keep LED3 "off" by default using input mode (board wiring dependent).
-    led_blue_yellow_in = new DigitalIn(LED3, PullNone);
+    led_blue_yellow_in = led_blue_yellow_in_storage.construct(LED3, PullNone);
     return true;
 }
 
@@ -35,11 +42,11 @@ void led_green_2_set(float value) {
 void led_blue_on() {
     // Ensure LED3 is in output mode so we can drive it.
     if (led_blue_yellow_in != nullptr) {
-        delete led_blue_yellow_in;
+        led_blue_yellow_in_storage.destroy();
         led_blue_yellow_in = nullptr;
     }
     if (led_blue_yellow_out == nullptr) {
-        led_blue_yellow_out = new PwmOut(LED3);
+        led_blue_yellow_out = led_blue_yellow_out_storage.construct(LED3);
         led_blue_yellow_out->period_us(100);
     }
     led_blue_yellow_out->write(0);
@@ -48,11 +55,11 @@ void led_blue_on() {
 void led_yellow_on() {
     // Ensure LED3 is in output mode so we can drive it.
     if (led_blue_yellow_in != nullptr) {
-        delete led_blue_yellow_in;
+        led_blue_yellow_in_storage.destroy();
         led_blue_yellow_in = nullptr;
     }
     if (led_blue_yellow_out == nullptr) {
-        led_blue_yellow_out = new PwmOut(LED3);
+        led_blue_yellow_out = led_blue_yellow_out_storage.construct(LED3);
         led_blue_yellow_out->period_us(100);
     }
     led_blue_yellow_out->write(1);
@@ -61,11 +68,11 @@ void led_yellow_on() {
 void led_blue_yellow_on() {
     // Ensure LED3 is in output mode so we can drive it.
     if (led_blue_yellow_in != nullptr) {
-        delete led_blue_yellow_in;
+        led_blue_yellow_in_storage.destroy();
         led_blue_yellow_in = nullptr;
     }
     if (led_blue_yellow_out == nullptr) {
-        led_blue_yellow_out = new PwmOut(LED3);
+        led_blue_yellow_out = led_blue_yellow_out_storage.construct(LED3);
         led_blue_yellow_out->period_us(100);
     }
     led_blue_yellow_out->write(0.5);
@@ -74,9 +81,9 @@ void led_blue_yellow_on() {
 void led_blue_yellow_off() {
     if (led_blue_yellow_in != nullptr) {return;}
     if (led_blue_yellow_out != nullptr) {
-        delete led_blue_yellow_out;
+        led_blue_yellow_out_storage.destroy();
         led_blue_yellow_out = nullptr;
         // Return LED3 to input mode (high impedance).
-        led_blue_yellow_in = new DigitalIn(LED3, PullNone);
+        led_blue_yellow_in = led_blue_yellow_in_storage.construct(LED3, PullNone);
     }
 }
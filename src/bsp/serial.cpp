@@ -5,6 +5,10 @@
 
 #include "bsp/serial.hpp"
 #include "mbed.h"
+#include "static_storage.hpp"
+
+static static_storage<BufferedSerial> serial_port_storage;
+static Mutex serial_mutex_storage;
 
 BufferedSerial *serial_port = nullptr;
 Mutex *serial_mutex = nullptr;
@@ -15,8 +19,8 @@ FileHandle *mbed::mbed_override_console(int) {
 
 bool serial_init() {
     // USBTX/USBRX are the board default serial pins for the console.
-    serial_port = new BufferedSerial(USBTX, USBRX, 115200);
-    serial_mutex = new Mutex();
+    serial_port = serial_port_storage.construct(USBTX, USBRX, 115200);
+    serial_mutex = &serial_mutex_storage;
     return true;
 }
 
@@ -26,6 +30,13 @@ void serial_send(const char *data) {
     }
 }
 
+bool serial_read_char(char *c) {
+    if (serial_port == nullptr || !serial_port->readable()) {
+        return false;
+    }
+    return serial_port->read(c, 1) == 1;
+}
+
 void serial_lock() {
     if (serial_mutex != nullptr) {
         serial_mutex->lock();
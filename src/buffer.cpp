@@ -8,12 +8,31 @@
  */
 
 /**
- * @brief Create a mirror buffer.
+ * @brief Initialize a mirror buffer on caller-provided storage.
  *
- * The buffer allocates 2*window_size elements. Each pushed element is written
+ * The storage holds 2*window_size elements. Each pushed element is written
  * twice: at index i and i+window_size. This guarantees the last window is
  * always contiguous in memory.
  *
+ * @param mb Buffer handle to fill in.
+ * @param storage Backing storage (MIRROR_BUFFER_STORAGE_BYTES()).
+ * @param window_size Window length (elements).
+ * @param element_size Element size in bytes.
+ */
+void mirror_buffer_init(mirror_buffer_t *mb, void *storage, size_t window_size, size_t element_size) {
+    // Initialize memory to 0 for predictable startup behavior.
+    memset(storage, 0, MIRROR_BUFFER_STORAGE_BYTES(window_size, element_size));
+
+    mb->buffer = storage;
+    mb->window_size = window_size;
+    mb->element_size = element_size;
+    mb->capacity = window_size;
+    mb->write_index = 0;
+}
+
+/**
+ * @brief Create a mirror buffer on the heap.
+ *
  * @param window_size Window length (elements).
  * @param element_size Element size in bytes.
  * @return Buffer handle, or NULL on allocation failure.
@@ -22,21 +41,13 @@ mirror_buffer_t* mirror_buffer_create(size_t window_size, size_t element_size) {
     mirror_buffer_t *mb = (mirror_buffer_t*)malloc(sizeof(mirror_buffer_t));
     if (!mb) return NULL;
     
-    // Allocate 2x storage (mirror region).
-    size_t buffer_bytes = window_size * 2 * element_size;
-    mb->buffer = malloc(buffer_bytes);
-    if (!mb->buffer) {
+    void *storage = malloc(MIRROR_BUFFER_STORAGE_BYTES(window_size, element_size));
+    if (!storage) {
         free(mb);
         return NULL;
     }
     
-    // Initialize memory to 0 for predictable startup behavior.
-    memset(mb->buffer, 0, buffer_bytes);
-    
-    mb->window_size = window_size;
-    mb->element_size = element_size;
-    mb->write_index = 0;
-    
+    mirror_buffer_init(mb, storage, window_size, element_size);
     return mb;
 }
 
@@ -89,7 +100,7 @@ void* mirror_buffer_get_window(mirror_buffer_t *mb) {
 /**
  * @brief Get a contiguous pointer to a previous window.
  * @param mb Buffer handle.
- * @param offset Window offset in full cycles (0=current, 1=previous, ...).
+ * @param offset Window offset in elements (0=current, 1=one sample older, ...).
  * @return Pointer to the requested window (oldest -> newest).
  */
 void* mirror_buffer_get_window_offset(mirror_buffer_t *mb, uint32_t offset) {
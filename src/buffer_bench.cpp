@@ -0,0 +1,111 @@
+/**
+ * @file buffer_bench.cpp
+ * @brief Start-up microbenchmark of mirror_buffer_t vs mirror_buffer<T, N>
+ *        (build option BUFFER_BENCH).
+ *
+ * Both buffers hold int16 samples with an FFT_BUFFER_SIZE window, as in
+ * fft_task. Each case pushes an integer ramp for several full
+ * cycles and reports the average DWT cycles per push and per window fetch.
+ * The C buffer runs on static storage through mirror_buffer_init(). A third case
+ * compares one six-axis sample pushed into six single-channel buffers against
+ * one push into mirror_buffer_multi.
+ */
+
+#ifdef BUFFER_BENCH
+
+#define LOG_MODULE LOG_MODULE_TEST
+
+#include "buffer.hpp"
+#include "mbed.h"
+#include <inttypes.h>
+#include "logger.hpp"
+#include "profiler.hpp"
+#include "tasks/fft_task.hpp"
+#include "bsp/imu.hpp"
+
+#define BUFFER_BENCH_PUSHES (4 * FFT_BUFFER_SIZE)
+
+static int16_t bench_c_storage[MIRROR_BUFFER_STORAGE_BYTES(FFT_BUFFER_SIZE, sizeof(int16_t)) / sizeof(int16_t)];
+static mirror_buffer_t bench_c;
+static mirror_buffer<int16_t, FFT_BUFFER_SIZE> bench_typed;
+static mirror_buffer<int16_t, FFT_BUFFER_SIZE> bench_axes[IMU_RAW_WORDS];
+static mirror_buffer_multi<int16_t, IMU_RAW_WORDS, FFT_BUFFER_SIZE> bench_multi;
+static_assert(sizeof(bench_c_storage) + sizeof(bench_typed) + sizeof(bench_axes) + sizeof(bench_multi) == BUFFER_BENCH_BYTES,
+    "update BUFFER_BENCH_BYTES");
+static const void * volatile bench_sink;
+
+static void bench_report(const char *name, uint32_t c_cycles, uint32_t typed_cycles) {
+    LOG_INFO("Buffer bench %-6s: mirror_buffer_t %4" PRIu32 " cyc, mirror_buffer<> %4" PRIu32 " cyc",
+        name, c_cycles, typed_cycles);
+}
+
+void buffer_bench_run() {
+    mirror_buffer_t *c_buffer = &bench_c;
+    mirror_buffer_init(c_buffer, bench_c_storage, FFT_BUFFER_SIZE, sizeof(int16_t));
+    bench_typed.reset();
+    profile_counter_enable();
+
+    uint32_t start = profile_counter_now();
+    for (int i = 0; i < BUFFER_BENCH_PUSHES; i++) {
+        int16_t value = (int16_t)i;
+        mirror_buffer_push(c_buffer, &value);
+    }
+    uint32_t c_push = (profile_counter_now() - start) / BUFFER_BENCH_PUSHES;
+
+    start = profile_counter_now();
+    for (int i = 0; i < BUFFER_BENCH_PUSHES; i++) {
+        bench_typed.push((int16_t)i);
+    }
+    uint32_t typed_push = (profile_counter_now() - start) / BUFFER_BENCH_PUSHES;
+
+    start = profile_counter_now();
+    for (int i = 0; i < BUFFER_BENCH_PUSHES; i++) {
+        bench_sink = mirror_buffer_get_window(c_buffer);
+    }
+    uint32_t c_window = (profile_counter_now() - start) / BUFFER_BENCH_PUSHES;
+
+    start = profile_counter_now();
+    for (int i = 0; i < BUFFER_BENCH_PUSHES; i++) {
+        bench_sink = bench_typed.window();
+    }
+    uint32_t typed_window = (profile_counter_now() - start) / BUFFER_BENCH_PUSHES;
+
+    // Both must expose the same window contents.
+    if (memcmp(mirror_buffer_get_window(c_buffer), bench_typed.window(), FFT_BUFFER_SIZE * sizeof(int16_t)) != 0) {
+        LOG_ERROR("Buffer bench: windows differ");
+    }
+
+    // Per-sample cost: six separate buffers vs one shared-index buffer.
+    int16_t raw[IMU_RAW_WORDS];
+    for (int i = 0; i < IMU_RAW_WORDS; i++) {
+        bench_axes[i].reset();
+    }
+    bench_multi.reset();
+
+    start = profile_counter_now();
+    for (int n = 0; n < BUFFER_BENCH_PUSHES; n++) {
+        for (int i = 0; i < IMU_RAW_WORDS; i++) {
+            raw[i] = (int16_t)(n + i);
+        }
+        for (int i = 0; i < IMU_RAW_WORDS; i++) {
+            bench_axes[i].push(raw[i]);
+        }
+    }
+    uint32_t axes_sample = (profile_counter_now() - start) / BUFFER_BENCH_PUSHES;
+
+    start = profile_counter_now();
+    for (int n = 0; n < BUFFER_BENCH_PUSHES; n++) {
+        for (int i = 0; i < IMU_RAW_WORDS; i++) {
+            raw[i] = (int16_t)(n + i);
+        }
+        bench_multi.push(raw);
+    }
+    uint32_t multi_sample = (profile_counter_now() - start) / BUFFER_BENCH_PUSHES;
+
+    bench_report("push", c_push, typed_push);
+    bench_report("window", c_window, typed_window);
+    LOG_INFO("Buffer bench sample: %d x mirror_buffer<> %4" PRIu32 " cyc, mirror_buffer_multi<> %4" PRIu32 " cyc",
+        IMU_RAW_WORDS, axes_sample, multi_sample);
+}
+
+#endif // BUFFER_BENCH
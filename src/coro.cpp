@@ -0,0 +1,141 @@
+/**
+ * @file coro.cpp
+ * @brief Implementation of the stackless-coroutine executor.
+ *
+ * Only compiled in when PIPELINE_COROUTINES is defined (requires C++20 and a
+ * toolchain with coroutine support, see platformio.ini).
+ *
+ * Scheduling model:
+ * - Each round snapshots and clears the pending event bits, then walks the
+ *   stages in spawn order and resumes every stage whose event was raised or
+ *   whose sleep deadline has passed.
+ * - Events raised during a round (e.g. a frame produced by the spectral stage)
+ *   are handled in the next round, which starts without blocking.
+ * - When nothing is pending, the thread blocks until the nearest deadline or
+ *   until coro::notify() wakes it.
+ */
+
+#ifdef PIPELINE_COROUTINES
+
+#include "coro.hpp"
+#include <atomic>
+
+namespace coro {
+
+typedef struct {
+    std::coroutine_handle<> handle;
+    const char *name;
+    uint32_t wait_events;   // events that resume the stage (0 = none)
+    uint32_t wake_time_ms;  // sleep deadline, valid when sleeping
+    bool sleeping;
+} stage_t;
+
+static stage_t stages[CORO_MAX_STAGES];
+static int stage_count = 0;
+static int current_stage = -1;
+static std::atomic<uint32_t> pending_events(0);
+
+// Frames are never freed (stages run forever), so a bump allocator suffices.
+alignas(8) static uint8_t frame_pool[CORO_FRAME_POOL_SIZE];
+static_assert(sizeof(frame_pool) == CORO_FRAME_POOL_SIZE, "frame pool size differs from the RAM budget");
+static size_t frame_pool_offset = 0;
+
+void *task::promise_type::operator new(size_t size) noexcept {
+    size_t aligned = (size + 7u) & ~(size_t)7u;
+    if (frame_pool_offset + aligned > CORO_FRAME_POOL_SIZE) {
+        return nullptr;
+    }
+    void *ptr = &frame_pool[frame_pool_offset];
+    frame_pool_offset += aligned;
+    return ptr;
+}
+
+void task::promise_type::operator delete(void *ptr, size_t size) noexcept {
+    (void)ptr;
+    (void)size;
+}
+
+void sleep_awaiter::await_suspend(std::coroutine_handle<> handle) noexcept {
+    (void)handle;
+    stages[current_stage].sleeping = true;
+    stages[current_stage].wake_time_ms = coro_platform_now_ms() + ms;
+}
+
+void event_awaiter::await_suspend(std::coroutine_handle<> handle) noexcept {
+    (void)handle;
+    stages[current_stage].wait_events = events;
+}
+
+bool spawn(task t, const char *name) {
+    if (!t.handle || stage_count >= CORO_MAX_STAGES) {
+        return false;
+    }
+    stage_t *stage = &stages[stage_count++];
+    stage->handle = t.handle;
+    stage->name = name;
+    stage->wait_events = 0;
+    stage->sleeping = false;
+    return true;
+}
+
+void notify(uint32_t events) {
+    pending_events.fetch_or(events, std::memory_order_release);
+    coro_platform_wake();
+}
+
+void run() {
+    while (true) {
+        uint32_t events = pending_events.exchange(0, std::memory_order_acquire);
+        uint32_t now = coro_platform_now_ms();
+
+        for (int i = 0; i < stage_count; i++) {
+            stage_t *stage = &stages[i];
+            if (stage->handle.done()) {
+                continue;
+            }
+
+            // A freshly spawned stage waits on nothing and runs immediately.
+            bool idle_start = !stage->sleeping && stage->wait_events == 0;
+            bool event_ready = (stage->wait_events & events) != 0;
+            bool timer_ready = stage->sleeping && (int32_t)(now - stage->wake_time_ms) >= 0;
+            if (!idle_start && !event_ready && !timer_ready) {
+                continue;
+            }
+
+            stage->wait_events = 0;
+            stage->sleeping = false;
+            current_stage = i;
+            stage->handle.resume();
+            current_stage = -1;
+        }
+
+        // Events raised during this round start the next one right away.
+        if (pending_events.load(std::memory_order_acquire) != 0) {
+            continue;
+        }
+
+        // Block until the nearest sleep deadline or the next notify().
+        uint32_t timeout_ms = UINT32_MAX;
+        now = coro_platform_now_ms();
+        for (int i = 0; i < stage_count; i++) {
+            if (stages[i].sleeping) {
+                int32_t remaining = (int32_t)(stages[i].wake_time_ms - now);
+                uint32_t wait_ms = remaining > 0 ? (uint32_t)remaining : 0;
+                if (wait_ms < timeout_ms) {
+                    timeout_ms = wait_ms;
+                }
+            }
+        }
+        if (timeout_ms > 0) {
+            coro_platform_wait(timeout_ms);
+        }
+    }
+}
+
+size_t frame_pool_used() {
+    return frame_pool_offset;
+}
+
+} // namespace coro
+
+#endif // PIPELINE_COROUTINES
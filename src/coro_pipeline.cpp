@@ -0,0 +1,144 @@
+/**
+ * @file coro_pipeline.cpp
+ * @brief Pipeline stages written as coroutines (build option PIPELINE_COROUTINES).
+ *
+ * Same stage functions as the threaded build, scheduled by the coroutine
+ * executor on one thread. BLE keeps its own thread because its stack is
+ * driven by an EventQueue.
+ */
+
+#ifdef PIPELINE_COROUTINES
+
+#define LOG_MODULE LOG_MODULE_PIPELINE
+
+#include "pipeline.hpp"
+#include "coro.hpp"
+#include "mbed.h"
+#include "logger.hpp"
+#include "main.hpp"
+#include "tasks/imu_task.hpp"
+#include "tasks/fft_task.hpp"
+#include "tasks/analysis_task.hpp"
+#include "tasks/led_task.hpp"
+#include "tasks/test_task.hpp"
+#include "task_monitor.hpp"
+
+#define CORO_WAKE_FLAG 1u
+#define PIPELINE_WATCHDOG_PERIOD 1000ms
+
+static EventFlags coro_wake_flags;
+
+uint32_t coro_platform_now_ms() {
+    return (uint32_t)Kernel::Clock::now().time_since_epoch().count();
+}
+
+void coro_platform_wait(uint32_t timeout_ms) {
+    coro_wake_flags.wait_any_for(CORO_WAKE_FLAG, Kernel::Clock::duration(timeout_ms));
+}
+
+void coro_platform_wake() {
+    coro_wake_flags.set(CORO_WAKE_FLAG);
+}
+
+static imu_data_t coro_sample;
+static uint32_t coro_total_samples = 0;
+
+static task_monitor_t coro_sample_monitor;
+static task_monitor_t coro_frame_monitor;
+
+/**
+ * @brief IMU drain + spectral stage: one sample per wakeup, one frame every
+ *        PIPELINE_ANALYSIS_DECIMATION samples.
+ */
+static coro::task sample_stage() {
+    uint32_t decimation = 0;
+    while (true) {
+        co_await coro::next_sample();
+        task_monitor_begin(&coro_sample_monitor);
+        // Edges are coalesced into one event, so the latest edge time is the
+        // one being handled; earlier ones show up as missed edges.
+        bool sampled = imu_sample_read(&coro_sample, imu_data_ready_time_us());
+        if (sampled) {
+            coro_total_samples++;
+            fft_push_sample(&coro_sample);
+        }
+        bool frame_due = sampled && fft_window_ready() && ++decimation >= PIPELINE_ANALYSIS_DECIMATION;
+        if (frame_due) {
+            decimation = 0;
+            if (fft_compute(coro_sample.timestamp_us)) {
+                coro::notify(CORO_EVENT_FRAME);
+            }
+        }
+        task_monitor_end(&coro_sample_monitor);
+    }
+}
+
+static coro::task analysis_stage() {
+    while (true) {
+        co_await coro::next_frame();
+        task_monitor_begin(&coro_frame_monitor);
+        analysis_step();
+        task_monitor_end(&coro_frame_monitor);
+    }
+}
+
+static coro::task led_stage() {
+    while (true) {
+        led_step();
+        co_await coro::sleep(LED_TICK_PERIOD);
+    }
+}
+
+static coro::task report_stage() {
+    while (true) {
+        co_await coro::sleep(SAMPLE_TIME_MS * 1ms);
+        test_report();
+    }
+}
+
+static coro::task watchdog_stage() {
+    uint32_t last_samples = 0;
+    while (true) {
+        co_await coro::sleep(PIPELINE_WATCHDOG_PERIOD);
+        if (coro_total_samples == last_samples) {
+            LOG_FATAL("IMU data wait timeout");
+            trigger_fatal_error();
+        }
+        last_samples = coro_total_samples;
+    }
+}
+
+void pipeline_coro_task() {
+    LOG_INFO("Coroutine Pipeline Task Started");
+
+    if (!fft_init()) {
+        trigger_fatal_error();
+        return;
+    }
+    analysis_init();
+    test_init();
+
+    task_monitor_register(&coro_sample_monitor, "sample", TASK_MONITOR_PERIOD_US(IMU_SAMPLE_RATE_HZ), TASK_MONITOR_PERIOD_US(IMU_SAMPLE_RATE_HZ));
+    task_monitor_register(&coro_frame_monitor, "analysis", TASK_MONITOR_PERIOD_US(IMU_SAMPLE_RATE_HZ) * PIPELINE_ANALYSIS_DECIMATION, ANALYSIS_TASK_BUDGET_US);
+
+    bool spawned = coro::spawn(sample_stage(), "sample")
+        && coro::spawn(analysis_stage(), "analysis")
+        && coro::spawn(led_stage(), "led")
+        && coro::spawn(report_stage(), "report")
+        && coro::spawn(watchdog_stage(), "watchdog");
+    if (!spawned) {
+        LOG_FATAL("Failed to spawn pipeline stages");
+        trigger_fatal_error();
+        return;
+    }
+    LOG_INFO("Coroutine frames: %u B for 5 stages", (unsigned)coro::frame_pool_used());
+
+    // Data-ready edge -> sample event (ISR context).
+    imu_data_ready_attach([]() {
+        coro::notify(CORO_EVENT_SAMPLE);
+    });
+
+    coro::run();
+}
+
+#endif // PIPELINE_COROUTINES
@@ -0,0 +1,68 @@
+/**
+ * @file governor.cpp
+ * @brief Implementation of the CPU-load-adaptive quality governor.
+ */
+
+#define LOG_MODULE LOG_MODULE_FFT
+
+#include "governor.hpp"
+#include "mbed.h"
+#include <inttypes.h>
+#include "logger.hpp"
+
+static const char *governor_level_names[] = {
+    "NORMAL",
+    "LARGE_HOP",
+    "SKIP_ACCEL",
+    "SMALL_FFT"
+};
+
+// Written by the diagnostics task, read by the spectral stage.
+static volatile governor_level_t governor_level = GOVERNOR_LEVEL_NORMAL;
+static uint32_t governor_calm_periods = 0;
+
+void governor_update(uint8_t cpu_usage_pct, uint32_t backlog) {
+    governor_level_t level = governor_level;
+    governor_level_t new_level = level;
+
+    bool overload = cpu_usage_pct > GOVERNOR_HIGH_LOAD_PCT || backlog >= GOVERNOR_HIGH_BACKLOG;
+    bool calm = cpu_usage_pct < GOVERNOR_LOW_LOAD_PCT && backlog <= GOVERNOR_LOW_BACKLOG;
+
+    if (overload) {
+        governor_calm_periods = 0;
+        if (level + 1 < GOVERNOR_LEVEL_COUNT) {
+            new_level = (governor_level_t)(level + 1);
+        }
+    } else if (calm) {
+        governor_calm_periods++;
+        if (governor_calm_periods >= GOVERNOR_RELAX_PERIODS && level > GOVERNOR_LEVEL_NORMAL) {
+            new_level = (governor_level_t)(level - 1);
+            governor_calm_periods = 0;
+        }
+    } else {
+        // Between the thresholds: hold the current level.
+        governor_calm_periods = 0;
+    }
+
+    if (new_level != level) {
+        LOG_INFO("Governor: %s -> %s (cpu %d%%, backlog %" PRIu32 ")",
+            governor_level_names[level], governor_level_names[new_level], cpu_usage_pct, backlog);
+        governor_level = new_level;
+    }
+}
+
+governor_level_t governor_get_level() {
+    return governor_level;
+}
+
+uint32_t governor_hop_size() {
+    return governor_level >= GOVERNOR_LEVEL_LARGE_HOP ? GOVERNOR_LARGE_HOP : GOVERNOR_NORMAL_HOP;
+}
+
+bool governor_accel_enabled() {
+    return governor_level < GOVERNOR_LEVEL_SKIP_ACCEL;
+}
+
+bool governor_small_fft() {
+    return governor_level >= GOVERNOR_LEVEL_SMALL_FFT;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file activity_gate_test_host.cpp
+ * @brief Host test of activity gating against a simulated sensor.
+ *
+ * The simulated wearer moves or rests according to a script. The sensor
+ * model enters its sleep state after the WAKE_UP_DUR sleep duration without
+ * motion and leaves it on the first moving sample; it raises data-ready at
+ * 208 Hz while awake and 12.5 Hz asleep, and exposes the state in
+ * WAKE_UP_SRC on the LSM6DSL mock. Each edge runs activity_gate_step(), as
+ * imu_task does.
+ *
+ * Checked, per report period: the gated time and fraction from
+ * activity_gate_get_and_reset() against the time the sensor really slept
+ * (within the poll latency), the closure count and the gate state,
+ * including periods that start or end with the gate closed; and on every
+ * edge, that the returned action matches the gate state.
+ *
+ * Also checked: while an asynchronous read holds the bus, or the state read
+ * fails, the gate keeps its state in both directions and changes on the next
+ * successful poll.
+ */
+
+#include "activity_gate.hpp"
+#include "bsp/imu.hpp"
+#include "host_test.hpp"
+#include "lsm6dsl_mock.hpp"
+
+#define AWAKE_EDGE_US   (1000000 / IMU_SAMPLE_RATE_HZ)
+#define SLEEP_EDGE_US   80000   // 12.5 Hz
+// Gate latency bound: a poll interval plus a sleep-rate edge to close, one
+// sleep-rate edge to open.
+#define GATE_LATENCY_MS ((ACTIVITY_GATE_POLL_US + 2 * SLEEP_EDGE_US) / 1000 + 1)
+
+typedef struct {
+    uint64_t from_ms;
+    uint64_t to_ms;
+} motion_t;
+
+// Wearer moving; rest everywhere else.
+static const motion_t motion_script[] = {
+    { 0, 10000 },
+    { 40000, 60000 },
+    { 100000, 120000 },
+};
+#define MOTION_COUNT (sizeof(motion_script) / sizeof(motion_script[0]))
+
+static bool wearer_moving(uint64_t ms) {
+    for (size_t i = 0; i < MOTION_COUNT; i++) {
+        if (ms >= motion_script[i].from_ms && ms < motion_script[i].to_ms) return true;
+    }
+    return false;
+}
+
+static bool sensor_asleep = false;
+static bool edges_ok = true;            // actions consistent with the gate state
+static uint32_t edges_opened = 0;
+static uint64_t sensor_last_motion_us = 0;
+static uint64_t sensor_sleep_us = 0;     // time asleep in the current period
+
+// Sensor inactivity duration from WAKE_UP_DUR (1 LSB = 512 / ODR).
+static uint64_t sensor_sleep_delay_us() {
+    return (uint64_t)(lsm6dsl_mock_reg(WAKE_UP_DUR) & 0x0F) * 512 * 1000000 / IMU_SAMPLE_RATE_HZ;
+}
+
+// One output sample of the simulated sensor at the current time.
+static void sensor_sample() {
+    uint64_t now = fake_mbed_now_us();
+    if (wearer_moving(now / 1000)) {
+        sensor_last_motion_us = now;
+        sensor_asleep = false;
+    } else if (!sensor_asleep && now - sensor_last_motion_us >= sensor_sleep_delay_us()) {
+        sensor_asleep = true;
+    }
+    lsm6dsl_mock_set_reg(WAKE_UP_SRC, sensor_asleep ? WAKE_UP_SRC_SLEEP_STATE : 0);
+}
+
+// One imu_task edge: the action must agree with the gate state after it.
+static void gate_step() {
+    bool was_open = activity_gate_is_open();
+    activity_gate_edge_t edge = activity_gate_step((uint32_t)fake_mbed_now_us());
+    bool open = activity_gate_is_open();
+    switch (edge) {
+    case ACTIVITY_GATE_EDGE_PUBLISH:
+        if (!was_open || !open) edges_ok = false;
+        break;
+    case ACTIVITY_GATE_EDGE_CONSUMED:
+        if (open) edges_ok = false;
+        break;
+    case ACTIVITY_GATE_EDGE_OPENED:
+        if (was_open || !open) edges_ok = false;
+        edges_opened++;
+        break;
+    }
+}
+
+// Run edges until `until_ms`, accumulating the sensor's sleep time.
+static void run_until(uint64_t until_ms) {
+    uint64_t edge_us = fake_mbed_now_us();
+    while (edge_us < until_ms * 1000) {
+        if (fake_mbed_now_us() < edge_us) {
+            fake_mbed_advance_us(edge_us - fake_mbed_now_us());
+        }
+        sensor_sample();
+        uint64_t step = sensor_asleep ? SLEEP_EDGE_US : AWAKE_EDGE_US;
+        gate_step();
+        if (edge_us + step > until_ms * 1000) step = until_ms * 1000 - edge_us;
+        if (sensor_asleep) sensor_sleep_us += step;
+        edge_us += step;
+    }
+    if (fake_mbed_now_us() < until_ms * 1000) {
+        fake_mbed_advance_us(until_ms * 1000 - fake_mbed_now_us());
+    }
+}
+
+static void check_period(uint64_t until_ms, bool open, uint32_t closures) {
+    run_until(until_ms);
+    activity_gate_stats_t stats;
+    activity_gate_get_and_reset(&stats);
+    uint32_t slept_ms = (uint32_t)(sensor_sleep_us / 1000);
+    sensor_sleep_us = 0;
+
+    HOST_CHECK(stats.open == open);
+    HOST_CHECK(stats.closures == closures);
+    HOST_CHECK(edges_ok);
+    HOST_CHECK(stats.gated_ms <= slept_ms + GATE_LATENCY_MS);
+    HOST_CHECK(stats.gated_ms + GATE_LATENCY_MS >= slept_ms);
+    HOST_CHECK(stats.gated_pct == stats.gated_ms * 100 / stats.period_ms);
+    printf("period to %u s: sensor asleep %u ms, gated %u ms of %u ms (%u%%), closures %u\n",
+        (unsigned)(until_ms / 1000), (unsigned)slept_ms, (unsigned)stats.gated_ms,
+        (unsigned)stats.period_ms, (unsigned)stats.gated_pct, (unsigned)stats.closures);
+}
+
+static uint32_t async_done = 0;
+
+static void async_complete(bool ok) {
+    (void)ok;
+    async_done++;
+}
+
+// One poll of the given sensor state while the bus is held by an
+// asynchronous read, one with a failing read, then one that goes through.
+static void check_unknown_state(bool asleep) {
+    bool open = activity_gate_is_open();
+    activity_gate_edge_t unchanged = open ? ACTIVITY_GATE_EDGE_PUBLISH : ACTIVITY_GATE_EDGE_CONSUMED;
+    lsm6dsl_mock_set_reg(WAKE_UP_SRC, asleep ? WAKE_UP_SRC_SLEEP_STATE : 0);
+    uint32_t edge_us = (uint32_t)fake_mbed_now_us();
+
+    static int16_t raw[IMU_RAW_WORDS];
+    lsm6dsl_mock_set_transfer_latency(50000);
+    HOST_CHECK(imu_read_raw_async(raw, async_complete));
+    edge_us += ACTIVITY_GATE_POLL_US;
+    HOST_CHECK(activity_gate_step(edge_us) == unchanged);
+    HOST_CHECK(activity_gate_is_open() == open);
+    fake_mbed_advance_us(ACTIVITY_GATE_POLL_US);
+    HOST_CHECK(!imu_read_async_busy());
+
+    lsm6dsl_mock_fail_next_read(0);
+    edge_us += ACTIVITY_GATE_POLL_US;
+    HOST_CHECK(activity_gate_step(edge_us) == unchanged);
+    HOST_CHECK(activity_gate_is_open() == open);
+
+    edge_us += ACTIVITY_GATE_POLL_US;
+    HOST_CHECK(activity_gate_step(edge_us) == (open ? ACTIVITY_GATE_EDGE_CONSUMED : ACTIVITY_GATE_EDGE_OPENED));
+    HOST_CHECK(activity_gate_is_open() == !open);
+}
+
+int main() {
+    lsm6dsl_mock_reset();
+    HOST_CHECK(imu_init());
+    HOST_CHECK(imu_activity_enable(ACTIVITY_GATE_WAKE_THS, ACTIVITY_GATE_SLEEP_DUR));
+    HOST_CHECK(lsm6dsl_mock_reg(WAKE_UP_THS) == ACTIVITY_GATE_WAKE_THS);
+    HOST_CHECK(lsm6dsl_mock_reg(WAKE_UP_DUR) == ACTIVITY_GATE_SLEEP_DUR);
+    HOST_CHECK(lsm6dsl_mock_reg(TAP_CFG) == TAP_CFG_INACT_XL_12HZ5);
+    activity_gate_stats_t stats;
+    activity_gate_get_and_reset(&stats);
+
+    // Rest from 10 s to 40 s inside the period.
+    check_period(60000, true, 1);
+    HOST_CHECK(stats.open);
+    // Rest from 60 s to past the end of the period: still closed at report.
+    check_period(90000, false, 1);
+    // Closed at the start, open again at 100 s.
+    check_period(120000, true, 0);
+    // All motion: nothing gated.
+    check_period(121000, true, 0);
+    HOST_CHECK(edges_opened == 2);
+
+    // Going to sleep, then waking up, with the state unreadable at first.
+    check_unknown_state(true);
+    check_unknown_state(false);
+    HOST_CHECK(async_done == 2);
+    return host_test_finish("activity_gate");
+}
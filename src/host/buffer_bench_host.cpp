@@ -0,0 +1,80 @@
+/**
+ * @file buffer_bench_host.cpp
+ * @brief Host throughput benchmark of the mirror_buffer_* C API.
+ *
+ * Linked either against the copying buffer (buffer.cpp) or the double-mapped
+ * one (host/buffer_host.cpp), see the native_buffer_bench_* environments.
+ * For a few element sizes and window lengths it replays a synthetic stream:
+ * every sample is pushed, and every `window / 4` samples the current window
+ * is fetched and summed, as a sliding-window analysis would. Reports million
+ * samples per second for push only and for push + window scans.
+ */
+
+#include "buffer.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef BUFFER_BENCH_DOUBLE_MAPPED
+#define BUFFER_BENCH_IMPL "double-mapped"
+#else
+#define BUFFER_BENCH_IMPL "copying"
+#endif
+
+#define BUFFER_BENCH_SAMPLES (16u * 1024u * 1024u)
+
+static double bench_now_s() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Returns Msamples/s; `scan` also sums each window every window/4 pushes.
+static double bench_run(size_t window, size_t element_size, bool scan, uint64_t *checksum) {
+    mirror_buffer_t *mb = mirror_buffer_create(window, element_size);
+    if (!mb) {
+        fprintf(stderr, "mirror_buffer_create(%zu, %zu) failed\n", window, element_size);
+        return 0.0;
+    }
+
+    uint8_t element[64];
+    memset(element, 0, sizeof(element));
+    size_t hop = window / 4 ? window / 4 : 1;
+    uint64_t sum = 0;
+
+    double start = bench_now_s();
+    for (uint32_t n = 0; n < BUFFER_BENCH_SAMPLES; n++) {
+        memcpy(element, &n, sizeof(n));
+        mirror_buffer_push(mb, element);
+        if (scan && n % hop == 0) {
+            const uint8_t *w = (const uint8_t*)mirror_buffer_get_window(mb);
+            for (size_t i = 0; i < window * element_size; i += element_size) {
+                sum += w[i];
+            }
+        }
+    }
+    double elapsed = bench_now_s() - start;
+
+    mirror_buffer_destroy(mb);
+    *checksum += sum;
+    return (double)BUFFER_BENCH_SAMPLES / elapsed * 1e-6;
+}
+
+int main() {
+    static const size_t element_sizes[] = { 2, 12, 24 };   // int16, raw IMU sample, float32 x 6
+    static const size_t windows[] = { 256, 4096, 65536 };
+    uint64_t checksum = 0;
+
+    printf("mirror_buffer (%s), %u samples per run\n", BUFFER_BENCH_IMPL, BUFFER_BENCH_SAMPLES);
+    printf("%8s %8s %14s %14s\n", "elem B", "window", "push Ms/s", "push+scan Ms/s");
+    for (size_t e = 0; e < sizeof(element_sizes) / sizeof(element_sizes[0]); e++) {
+        for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+            double push = bench_run(windows[w], element_sizes[e], false, &checksum);
+            double scan = bench_run(windows[w], element_sizes[e], true, &checksum);
+            printf("%8zu %8zu %14.1f %14.1f\n", element_sizes[e], windows[w], push, scan);
+        }
+    }
+    // Keeps the scans observable.
+    printf("checksum %llu\n", (unsigned long long)checksum);
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file buffer_history_test_host.cpp
+ * @brief Host test of mirror_buffer_history against a plain reference history.
+ *
+ * Every pushed sample is also appended to a flat array, which gives the
+ * expected content of any window directly. For depths H = 1, 3, 4 and window
+ * lengths N = 4, 5, 8 (ring lengths of 4 to 32, most not powers of two),
+ * checked after every push and for every `back` up to one past the limit:
+ * - window_valid(back) holds exactly while back <= H*N - N and at least
+ *   N + back samples were pushed;
+ * - window_back() returns the expected N samples of every channel, or NULL;
+ * - the tail always mirrors the first N ring slots;
+ * - a window stays unchanged for H*N - N - back more pushes, and the push
+ *   after that overwrites its oldest element;
+ * - reset() clears the storage and the history.
+ */
+
+#include "buffer.hpp"
+#include "host_test.hpp"
+#include <string.h>
+
+#define CHANNELS 3
+#define PUSHES_PER_RING 3   // pushes per config, in ring lengths (plus a few)
+
+// Unique value of channel c at sample n.
+static int32_t sample_value(uint32_t n, size_t c) {
+    return (int32_t)(n * CHANNELS + c + 1);
+}
+
+template <size_t N, size_t H>
+static void test_config() {
+    typedef mirror_buffer_history<int32_t, CHANNELS, N, H> history_t;
+    const uint32_t ring = (uint32_t)history_t::ring_size;
+    const uint32_t pushes = PUSHES_PER_RING * ring + 7;
+
+    static history_t history;
+    static int32_t reference[CHANNELS][PUSHES_PER_RING * H * N + 7];
+    history.reset();
+    bool valid_ok = true;
+    bool content_ok = true;
+    bool tail_ok = true;
+
+    for (uint32_t n = 0; n < pushes; n++) {
+        int32_t values[CHANNELS];
+        for (size_t c = 0; c < CHANNELS; c++) {
+            values[c] = sample_value(n, c);
+            reference[c][n] = values[c];
+        }
+        history.push(values);
+        uint32_t total = n + 1;
+
+        for (uint32_t back = 0; back <= ring; back++) {
+            bool expected = back + N <= ring && total >= N + back;
+            if (history.window_valid(back) != expected) valid_ok = false;
+            for (size_t c = 0; c < CHANNELS; c++) {
+                const int32_t *window = history.window_back(c, back);
+                if (!expected) {
+                    if (window != NULL) content_ok = false;
+                    continue;
+                }
+                // Newest element of the window is sample total - 1 - back.
+                const int32_t *want = &reference[c][total - back - N];
+                if (window == NULL || memcmp(window, want, N * sizeof(int32_t)) != 0) content_ok = false;
+            }
+        }
+        for (size_t c = 0; c < CHANNELS; c++) {
+            if (history.window(c) != history.window_back(c, 0)) content_ok = false;
+            if (memcmp(&history.storage[c][ring], &history.storage[c][0], N * sizeof(int32_t)) != 0) tail_ok = false;
+        }
+    }
+    HOST_CHECK(valid_ok);
+    HOST_CHECK(content_ok);
+    HOST_CHECK(tail_ok);
+    HOST_CHECK(history.filled == ring);
+
+    // Lifetime of a window pointer, for every reach back.
+    uint32_t n = pushes;
+    for (uint32_t back = 0; back + N <= ring; back++) {
+        const int32_t *window = history.window_back(0, back);
+        if (!HOST_CHECK(window != NULL)) continue;
+        int32_t copy[N];
+        memcpy(copy, window, sizeof(copy));
+        for (uint32_t i = 0; i < ring - N - back; i++, n++) {
+            int32_t values[CHANNELS];
+            for (size_t c = 0; c < CHANNELS; c++) values[c] = sample_value(n, c);
+            history.push(values);
+        }
+        HOST_CHECK(memcmp(window, copy, sizeof(copy)) == 0);
+        int32_t values[CHANNELS];
+        for (size_t c = 0; c < CHANNELS; c++) values[c] = sample_value(n, c);
+        history.push(values);
+        n++;
+        HOST_CHECK(window[0] != copy[0]);
+        HOST_CHECK(memcmp(&window[1], &copy[1], (N - 1) * sizeof(int32_t)) == 0);
+    }
+
+    history.reset();
+    HOST_CHECK(history.write_index == 0);
+    HOST_CHECK(history.filled == 0);
+    HOST_CHECK(!history.window_valid(0));
+    HOST_CHECK(history.window(0) == NULL);
+    bool zero = true;
+    for (size_t c = 0; c < CHANNELS; c++) {
+        for (uint32_t i = 0; i < ring + N; i++) {
+            if (history.storage[c][i] != 0) zero = false;
+        }
+    }
+    HOST_CHECK(zero);
+}
+
+int main() {
+    test_config<4, 1>();
+    test_config<5, 1>();
+    test_config<8, 1>();
+    test_config<4, 3>();
+    test_config<5, 3>();
+    test_config<8, 3>();
+    test_config<4, 4>();
+    test_config<5, 4>();
+    test_config<8, 4>();
+    return host_test_finish("buffer_history");
+}
@@ -0,0 +1,134 @@
+/**
+ * @file buffer_host.cpp
+ * @brief Linux host implementation of the mirror buffer on a double-mapped ring.
+ *
+ * The ring is one memfd of `capacity * element_size` bytes (page-rounded),
+ * mapped twice back to back in a reserved address range. Byte `i` and byte
+ * `i + ring_bytes` are the same physical memory, so each element is written
+ * once and any run of up to `capacity` elements is contiguous, whatever its
+ * start index. Windows are therefore limited only by the ring size, which
+ * makes the buffer suitable for replaying long recordings on a host with
+ * large or varying window lengths.
+ *
+ * Built only for host environments (see platformio.ini); the target uses the
+ * copying implementation in buffer.cpp.
+ */
+
+#ifdef __linux__
+
+#include "buffer.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Smallest page multiple that holds `min_bytes` and is a whole number of elements.
+static size_t mirror_buffer_ring_bytes(size_t min_bytes, size_t element_size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t ring_bytes = (min_bytes + page - 1) / page * page;
+    while (ring_bytes % element_size != 0) {
+        ring_bytes += page;
+    }
+    return ring_bytes;
+}
+
+// Map `fd` twice in a row; returns the base of the 2*ring_bytes view or NULL.
+static void *mirror_buffer_map(int fd, size_t ring_bytes) {
+    // Reserve the whole range first so both halves land next to each other.
+    void *base = mmap(NULL, 2 * ring_bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return NULL;
+
+    uint8_t *lower = (uint8_t*)base;
+    uint8_t *upper = lower + ring_bytes;
+    if (mmap(lower, ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+        || mmap(upper, ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, 2 * ring_bytes);
+        return NULL;
+    }
+    return base;
+}
+
+/**
+ * @brief Create a double-mapped mirror buffer.
+ *
+ * The ring holds at least `window_size` elements; extra room from page
+ * rounding is usable through mirror_buffer_get_window_offset(). memfd pages
+ * start zero-filled.
+ *
+ * @param window_size Window length (elements).
+ * @param element_size Element size in bytes.
+ * @return Buffer handle, or NULL on failure.
+ */
+mirror_buffer_t* mirror_buffer_create(size_t window_size, size_t element_size) {
+    if (window_size == 0 || element_size == 0) return NULL;
+
+    mirror_buffer_t *mb = (mirror_buffer_t*)malloc(sizeof(mirror_buffer_t));
+    if (!mb) return NULL;
+
+    size_t ring_bytes = mirror_buffer_ring_bytes(window_size * element_size, element_size);
+    int fd = memfd_create("mirror_buffer", MFD_CLOEXEC);
+    if (fd < 0) {
+        free(mb);
+        return NULL;
+    }
+    void *base = NULL;
+    if (ftruncate(fd, (off_t)ring_bytes) == 0) {
+        base = mirror_buffer_map(fd, ring_bytes);
+    }
+    // The mappings keep the memory alive.
+    close(fd);
+    if (!base) {
+        free(mb);
+        return NULL;
+    }
+
+    mb->buffer = base;
+    mb->window_size = window_size;
+    mb->element_size = element_size;
+    mb->capacity = ring_bytes / element_size;
+    mb->write_index = 0;
+    return mb;
+}
+
+/**
+ * @brief Destroy a mirror buffer and unmap both views.
+ */
+void mirror_buffer_destroy(mirror_buffer_t *mb) {
+    if (mb) {
+        if (mb->buffer) munmap(mb->buffer, 2 * mb->capacity * mb->element_size);
+        free(mb);
+    }
+}
+
+/**
+ * @brief Push one element (single write; the second view sees it too).
+ */
+void mirror_buffer_push(mirror_buffer_t *mb, const void *data) {
+    if (!mb || !data) return;
+
+    memcpy((uint8_t*)mb->buffer + (size_t)mb->write_index * mb->element_size, data, mb->element_size);
+    if (++mb->write_index == mb->capacity) {
+        mb->write_index = 0;
+    }
+}
+
+/**
+ * @brief Get the newest `window_size` elements (oldest -> newest).
+ */
+void* mirror_buffer_get_window(mirror_buffer_t *mb) {
+    return mirror_buffer_get_window_offset(mb, 0);
+}
+
+/**
+ * @brief Get the window ending `offset` elements before the newest one.
+ */
+void* mirror_buffer_get_window_offset(mirror_buffer_t *mb, uint32_t offset) {
+    if (!mb) return NULL;
+
+    // write_index - window_size - offset, kept in 0..capacity-1.
+    size_t back = (mb->window_size + offset) % mb->capacity;
+    size_t start = (mb->write_index + mb->capacity - back) % mb->capacity;
+    return (void*)((uint8_t*)mb->buffer + start * mb->element_size);
+}
+
+#endif // __linux__
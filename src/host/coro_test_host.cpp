@@ -0,0 +1,248 @@
+/**
+ * @file coro_test_host.cpp
+ * @brief Host test of the coroutine executor (coro.cpp) on a fake platform.
+ *
+ * The three coro_platform_* hooks run on a simulated millisecond clock:
+ * coro_platform_wait() jumps the clock to the requested deadline, or to the
+ * next scripted "interrupt" if that comes first, in which case it raises the
+ * interrupt's events with coro::notify() the way the data-ready ISR does.
+ * Once the clock would pass the end of the script it throws, which is the
+ * only way out of coro::run().
+ *
+ * Checked:
+ * - sleeping stages resume exactly at their deadlines, in time order, and in
+ *   spawn order when deadlines coincide; the executor blocks for exactly the
+ *   time to the nearest deadline;
+ * - event stages resume once per raised event and only for their own event,
+ *   and an event raised during a round is handled in the next round without
+ *   blocking;
+ * - spawn() fails cleanly when the frame pool or the stage table is full.
+ */
+
+#include "coro.hpp"
+#include "host_test.hpp"
+#include <stdint.h>
+
+using namespace std::chrono_literals;
+
+// Stage ids in the resume log.
+enum {
+    STAGE_SLEEP_20 = 0,
+    STAGE_SLEEP_30,
+    STAGE_SAMPLE,
+    STAGE_FRAME,
+};
+
+typedef struct {
+    uint32_t time_ms;
+    int stage;
+    uint32_t waits;     // fake_waits when the stage resumed
+} resume_t;
+
+typedef struct {
+    uint32_t time_ms;
+    uint32_t events;
+} fake_irq_t;
+
+// Data-ready "interrupts"; 60 ms coincides with both sleepers.
+static const fake_irq_t fake_irqs[] = {
+    { 5, CORO_EVENT_SAMPLE },
+    { 12, CORO_EVENT_SAMPLE },
+    { 33, CORO_EVENT_SAMPLE },
+    { 47, CORO_EVENT_SAMPLE },
+    { 60, CORO_EVENT_SAMPLE },
+    { 81, CORO_EVENT_SAMPLE },
+};
+#define FAKE_IRQ_COUNT (sizeof(fake_irqs) / sizeof(fake_irqs[0]))
+#define FAKE_END_MS 100
+
+static uint32_t fake_now_ms = 0;
+static uint32_t fake_waits = 0;
+static uint32_t fake_wakes = 0;
+static size_t fake_irq_next = 0;
+static bool fake_timeout_ok = true;
+
+static resume_t resumes[64];
+static int resume_count = 0;
+
+struct fake_end_of_script {};
+
+uint32_t coro_platform_now_ms() {
+    return fake_now_ms;
+}
+
+void coro_platform_wait(uint32_t timeout_ms) {
+    fake_waits++;
+    uint32_t deadline = timeout_ms == UINT32_MAX ? UINT32_MAX : fake_now_ms + timeout_ms;
+
+    // The executor must never ask to block past a sleeping stage's deadline:
+    // with two periodic sleepers the nearest deadline is at most 20 ms away.
+    if (timeout_ms > 20) {
+        fake_timeout_ok = false;
+    }
+
+    if (fake_irq_next < FAKE_IRQ_COUNT && fake_irqs[fake_irq_next].time_ms <= deadline) {
+        fake_now_ms = fake_irqs[fake_irq_next].time_ms;
+        coro::notify(fake_irqs[fake_irq_next].events);
+        fake_irq_next++;
+        return;
+    }
+    if (deadline > FAKE_END_MS) {
+        throw fake_end_of_script();
+    }
+    fake_now_ms = deadline;
+}
+
+void coro_platform_wake() {
+    fake_wakes++;
+}
+
+static void log_resume(int stage) {
+    if (resume_count < (int)(sizeof(resumes) / sizeof(resumes[0]))) {
+        resumes[resume_count++] = { fake_now_ms, stage, fake_waits };
+    }
+}
+
+static coro::task sleep_20_stage() {
+    while (true) {
+        log_resume(STAGE_SLEEP_20);
+        co_await coro::sleep(20ms);
+    }
+}
+
+static coro::task sleep_30_stage() {
+    while (true) {
+        log_resume(STAGE_SLEEP_30);
+        co_await coro::sleep(30ms);
+    }
+}
+
+// Produces a frame every second sample, like the spectral stage.
+static coro::task sample_stage() {
+    uint32_t samples = 0;
+    while (true) {
+        co_await coro::next_sample();
+        log_resume(STAGE_SAMPLE);
+        if (++samples % 2 == 0) {
+            coro::notify(CORO_EVENT_FRAME);
+        }
+    }
+}
+
+static coro::task frame_stage() {
+    while (true) {
+        co_await coro::next_frame();
+        log_resume(STAGE_FRAME);
+    }
+}
+
+// Keeps a pool-sized array alive across a suspension, so its frame cannot fit.
+static coro::task oversized_stage() {
+    volatile uint8_t scratch[CORO_FRAME_POOL_SIZE];
+    scratch[0] = 1;
+    co_await coro::sleep(1ms);
+    scratch[1] = scratch[0];
+}
+
+static int count_resumes(int stage) {
+    int n = 0;
+    for (int i = 0; i < resume_count; i++) {
+        if (resumes[i].stage == stage) n++;
+    }
+    return n;
+}
+
+static void test_sleep_ordering() {
+    uint32_t expected_20 = 0;
+    uint32_t expected_30 = 0;
+    for (int i = 0; i < resume_count; i++) {
+        if (i > 0) {
+            HOST_CHECK(resumes[i].time_ms >= resumes[i - 1].time_ms);
+        }
+        if (resumes[i].stage == STAGE_SLEEP_20) {
+            HOST_CHECK(resumes[i].time_ms == expected_20);
+            expected_20 += 20;
+        } else if (resumes[i].stage == STAGE_SLEEP_30) {
+            HOST_CHECK(resumes[i].time_ms == expected_30);
+            expected_30 += 30;
+        }
+    }
+    // 0..100 ms: 20 ms stage at 0, 20, ..., 100; 30 ms stage at 0, 30, 60, 90.
+    HOST_CHECK(count_resumes(STAGE_SLEEP_20) == 6);
+    HOST_CHECK(count_resumes(STAGE_SLEEP_30) == 4);
+    HOST_CHECK(fake_timeout_ok);
+
+    // Same deadline: spawn order.
+    int first_at_60 = -1;
+    for (int i = 0; i < resume_count && first_at_60 < 0; i++) {
+        if (resumes[i].time_ms == 60 && resumes[i].stage != STAGE_SAMPLE) {
+            first_at_60 = resumes[i].stage;
+        }
+    }
+    HOST_CHECK(first_at_60 == STAGE_SLEEP_20);
+}
+
+static void test_event_wakeups() {
+    // One resume per interrupt, at the interrupt time.
+    HOST_CHECK(count_resumes(STAGE_SAMPLE) == (int)FAKE_IRQ_COUNT);
+    HOST_CHECK(fake_wakes >= FAKE_IRQ_COUNT);
+    size_t irq = 0;
+    for (int i = 0; i < resume_count; i++) {
+        if (resumes[i].stage == STAGE_SAMPLE && irq < FAKE_IRQ_COUNT) {
+            HOST_CHECK(resumes[i].time_ms == fake_irqs[irq].time_ms);
+            irq++;
+        }
+    }
+
+    // Frames only on every second sample, in the very next round: same time
+    // and no blocking wait in between.
+    HOST_CHECK(count_resumes(STAGE_FRAME) == (int)FAKE_IRQ_COUNT / 2);
+    int samples = 0;
+    for (int i = 0; i < resume_count; i++) {
+        if (resumes[i].stage != STAGE_SAMPLE || ++samples % 2 != 0) {
+            continue;
+        }
+        bool found = false;
+        for (int j = i + 1; j < resume_count && !found; j++) {
+            if (resumes[j].stage == STAGE_FRAME) {
+                HOST_CHECK(resumes[j].time_ms == resumes[i].time_ms);
+                HOST_CHECK(resumes[j].waits == resumes[i].waits);
+                found = true;
+            }
+        }
+        HOST_CHECK(found);
+    }
+}
+
+static void test_spawn_failures() {
+    // Frame pool exhausted: spawn fails and the pool is unchanged.
+    size_t used = coro::frame_pool_used();
+    HOST_CHECK(!coro::spawn(oversized_stage(), "oversized"));
+    HOST_CHECK(coro::frame_pool_used() == used);
+
+    // Stage table: four stages are running, so two more fit.
+    HOST_CHECK(CORO_MAX_STAGES == 6);
+    HOST_CHECK(coro::spawn(sleep_20_stage(), "extra1"));
+    HOST_CHECK(coro::spawn(sleep_30_stage(), "extra2"));
+    HOST_CHECK(!coro::spawn(frame_stage(), "extra3"));
+}
+
+int main() {
+    HOST_CHECK(coro::spawn(sleep_20_stage(), "sleep20"));
+    HOST_CHECK(coro::spawn(sleep_30_stage(), "sleep30"));
+    HOST_CHECK(coro::spawn(sample_stage(), "sample"));
+    HOST_CHECK(coro::spawn(frame_stage(), "frame"));
+    HOST_CHECK(coro::frame_pool_used() > 0);
+    HOST_CHECK(coro::frame_pool_used() <= CORO_FRAME_POOL_SIZE);
+
+    try {
+        coro::run();
+    } catch (const fake_end_of_script &) {
+    }
+    HOST_CHECK(fake_irq_next == FAKE_IRQ_COUNT);
+
+    test_sleep_ordering();
+    test_event_wakeups();
+    test_spawn_failures();
+    return host_test_finish("coro");
+}
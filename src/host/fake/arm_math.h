@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ * @file arm_math.h
+ * @brief Fake CMSIS-DSP header for the host tests: types only.
+ */
+
+#include <stdint.h>
+
+typedef float float32_t;
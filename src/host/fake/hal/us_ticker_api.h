@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ * @file us_ticker_api.h
+ * @brief Fake microsecond ticker: the low 32 bits of the simulated clock.
+ */
+
+#include <stdint.h>
+
+uint32_t us_ticker_read();
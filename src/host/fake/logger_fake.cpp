@@ -0,0 +1,22 @@
+/**
+ * @file logger_fake.cpp
+ * @brief Logger back end for the host tests: plain lines on stdout.
+ */
+
+#include "logger.hpp"
+#include <stdarg.h>
+#include <stdio.h>
+
+static const char *log_fake_level_names[] = { "DEBUG", "INFO", "WARN", "ERROR", "FATAL" };
+
+LogLevel_t g_log_level = LOG_LEVEL_INFO;
+LogLevel_t g_log_module_levels[LOG_MODULE_COUNT];
+
+void log_print(LogLevel_t level, const char* format, ...) {
+    printf("[%s] ", log_fake_level_names[level]);
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+}
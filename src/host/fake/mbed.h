@@ -0,0 +1,190 @@
+#pragma once
+
+/**
+ * @file mbed.h
+ * @brief Fake Mbed OS API for the host tests (native_test_* environments).
+ *
+ * Only what the modules under test use, single-threaded and driven by a
+ * simulated microsecond clock (fake_mbed_now_us(), fake_mbed_advance_us());
+ * "interrupts" run from fake_mbed_advance_us() when their time comes.
+ * The I2C bus is implemented by the sensor mock (host/lsm6dsl_mock.cpp);
+ * interrupt pins fire when the test calls fake_mbed_pin_rise().
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <chrono>
+#include <functional>
+
+using namespace std::chrono_literals;
+
+/**
+ * @brief Board pins used by the BSP.
+ */
+typedef enum {
+    PB_10,
+    PB_11,
+    PD_11,
+    FAKE_PIN_COUNT
+} PinName;
+
+typedef enum {
+    PullNone,
+    PullUp,
+    PullDown
+} PinMode;
+
+/** The fake I2C supports transfer(), as the target does. */
+#define DEVICE_I2C_ASYNCH 1
+
+#define I2C_EVENT_ERROR                 (1 << 1)
+#define I2C_EVENT_ERROR_NO_SLAVE        (1 << 2)
+#define I2C_EVENT_TRANSFER_COMPLETE     (1 << 3)
+#define I2C_EVENT_TRANSFER_EARLY_NACK   (1 << 4)
+#define I2C_EVENT_ALL (I2C_EVENT_ERROR | I2C_EVENT_TRANSFER_COMPLETE | I2C_EVENT_ERROR_NO_SLAVE | I2C_EVENT_TRANSFER_EARLY_NACK)
+
+#define osWaitForever       0xFFFFFFFFu
+#define osFlagsErrorTimeout 0xFFFFFFFEu
+
+namespace mbed {
+
+/**
+ * @brief Callback with the Mbed constructor set (function, lambda, nullptr).
+ */
+template <typename F>
+class Callback;
+
+template <typename R, typename... A>
+class Callback<R(A...)> {
+public:
+    Callback() {}
+    Callback(std::nullptr_t) {}
+    template <typename F>
+    Callback(F f) : fn(f) {}
+    template <typename O, typename M>
+    Callback(O *obj, M method) : fn([obj, method](A... args) { return (obj->*method)(args...); }) {}
+
+    R operator()(A... args) const { return fn(args...); }
+    explicit operator bool() const { return (bool)fn; }
+
+private:
+    std::function<R(A...)> fn;
+};
+
+typedef Callback<void(int)> event_callback_t;
+
+/**
+ * @brief I2C master; every transaction goes to the sensor mock.
+ *
+ * transfer() returns at once and calls `callback` from a scheduled
+ * "interrupt" when the simulated clock reaches the end of the transfer.
+ */
+class I2C {
+public:
+    I2C(PinName sda, PinName scl);
+    void frequency(int hz);
+    int write(int address, const char *data, int length, bool repeated = false);
+    int read(int address, char *data, int length, bool repeated = false);
+    int transfer(int address, const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length,
+                 const event_callback_t &callback, int event = I2C_EVENT_TRANSFER_COMPLETE, bool repeated = false);
+};
+
+/**
+ * @brief Edge interrupt; fake_mbed_pin_rise() calls the rise handler.
+ */
+class InterruptIn {
+public:
+    InterruptIn(PinName pin, PinMode mode = PullNone);
+    void rise(Callback<void()> handler);
+
+private:
+    PinName pin;
+};
+
+} // namespace mbed
+
+using namespace mbed;
+
+namespace rtos {
+
+namespace Kernel {
+
+/**
+ * @brief RTOS millisecond clock on the simulated time.
+ */
+struct Clock {
+    typedef std::chrono::duration<int64_t, std::milli> duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<Clock> time_point;
+    static const bool is_steady = true;
+    static time_point now();
+};
+
+} // namespace Kernel
+
+/**
+ * @brief Mutex for a single thread: nothing to exclude.
+ */
+class Mutex {
+public:
+    void lock() {}
+    void unlock() {}
+    bool trylock() { return true; }
+};
+
+/**
+ * @brief Event flags without blocking: a wait returns at once.
+ */
+class EventFlags {
+public:
+    uint32_t set(uint32_t flags) { return bits |= flags; }
+    uint32_t clear(uint32_t flags = 0x7FFFFFFFu) {
+        uint32_t old = bits;
+        bits &= ~flags;
+        return old;
+    }
+    uint32_t get() const { return bits; }
+    uint32_t wait_all(uint32_t flags, uint32_t millisec = osWaitForever, bool clear_flags = true) {
+        (void)millisec;
+        if ((bits & flags) != flags) return osFlagsErrorTimeout;
+        uint32_t old = bits;
+        if (clear_flags) bits &= ~flags;
+        return old;
+    }
+    uint32_t wait_any(uint32_t flags, uint32_t millisec = osWaitForever, bool clear_flags = true) {
+        (void)millisec;
+        if ((bits & flags) == 0) return osFlagsErrorTimeout;
+        uint32_t old = bits;
+        if (clear_flags) bits &= ~flags;
+        return old;
+    }
+
+private:
+    uint32_t bits = 0;
+};
+
+} // namespace rtos
+
+using namespace rtos;
+
+/**
+ * @brief Current simulated time in microseconds.
+ */
+uint64_t fake_mbed_now_us();
+
+/**
+ * @brief Advance the simulated clock, running the interrupts that fall due.
+ */
+void fake_mbed_advance_us(uint64_t us);
+
+/**
+ * @brief Run `handler` as an interrupt when the clock reaches `at_us`.
+ */
+void fake_mbed_schedule(uint64_t at_us, Callback<void()> handler);
+
+/**
+ * @brief Raise a rising edge on `pin` (calls its InterruptIn handler, if any).
+ */
+void fake_mbed_pin_rise(PinName pin);
@@ -0,0 +1,87 @@
+/**
+ * @file mbed_fake.cpp
+ * @brief Simulated clock and interrupt pins behind the fake Mbed API.
+ */
+
+#include "mbed.h"
+#include "hal/us_ticker_api.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FAKE_TIMER_SLOTS 8
+
+typedef struct {
+    uint64_t at_us;
+    Callback<void()> handler;
+} fake_timer_t;
+
+static uint64_t fake_now = 0;
+static Callback<void()> fake_rise_handlers[FAKE_PIN_COUNT];
+static fake_timer_t fake_timers[FAKE_TIMER_SLOTS];
+
+uint64_t fake_mbed_now_us() {
+    return fake_now;
+}
+
+// Earliest pending timer due by `until`, or -1.
+static int fake_timer_due(uint64_t until) {
+    int due = -1;
+    for (int i = 0; i < FAKE_TIMER_SLOTS; i++) {
+        if (fake_timers[i].handler && fake_timers[i].at_us <= until &&
+            (due < 0 || fake_timers[i].at_us < fake_timers[due].at_us)) {
+            due = i;
+        }
+    }
+    return due;
+}
+
+void fake_mbed_advance_us(uint64_t us) {
+    uint64_t until = fake_now + us;
+    int due;
+    while ((due = fake_timer_due(until)) >= 0) {
+        Callback<void()> handler = fake_timers[due].handler;
+        fake_timers[due].handler = nullptr;
+        if (fake_timers[due].at_us > fake_now) {
+            fake_now = fake_timers[due].at_us;
+        }
+        handler();
+    }
+    // A handler may have advanced the clock itself (blocking bus access).
+    if (fake_now < until) {
+        fake_now = until;
+    }
+}
+
+void fake_mbed_schedule(uint64_t at_us, Callback<void()> handler) {
+    for (int i = 0; i < FAKE_TIMER_SLOTS; i++) {
+        if (!fake_timers[i].handler) {
+            fake_timers[i].at_us = at_us;
+            fake_timers[i].handler = handler;
+            return;
+        }
+    }
+    fprintf(stderr, "fake_mbed_schedule: no free timer slot\n");
+    abort();
+}
+
+void fake_mbed_pin_rise(PinName pin) {
+    if (fake_rise_handlers[pin]) {
+        fake_rise_handlers[pin]();
+    }
+}
+
+Kernel::Clock::time_point Kernel::Clock::now() {
+    return time_point(duration((int64_t)(fake_now / 1000)));
+}
+
+uint32_t us_ticker_read() {
+    return (uint32_t)fake_now;
+}
+
+InterruptIn::InterruptIn(PinName pin, PinMode mode) : pin(pin) {
+    (void)mode;
+}
+
+void InterruptIn::rise(Callback<void()> handler) {
+    fake_rise_handlers[pin] = handler;
+}
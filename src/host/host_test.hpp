@@ -0,0 +1,40 @@
+#pragma once
+
+/**
+ * @file host_test.hpp
+ * @brief Minimal check helpers for the host test programs (native_test_* envs).
+ *
+ * Each test program is a plain executable: HOST_CHECK() prints failures with
+ * their location and keeps going, host_test_finish() prints a summary and
+ * returns the process exit code. Run one with
+ *
+ *     pio run -e native_test_<name> -t exec
+ */
+
+#include <stdio.h>
+
+static int host_test_checks = 0;
+static int host_test_failures = 0;
+
+static inline bool host_test_check(bool ok, const char *expr, const char *file, int line) {
+    host_test_checks++;
+    if (!ok) {
+        host_test_failures++;
+        printf("FAIL %s:%d: %s\n", file, line, expr);
+    }
+    return ok;
+}
+
+/**
+ * @brief Check a condition; on failure print it and count it.
+ */
+#define HOST_CHECK(cond) host_test_check((cond), #cond, __FILE__, __LINE__)
+
+/**
+ * @brief Print the summary of a test program.
+ * @return Exit code: 0 if every check passed.
+ */
+static inline int host_test_finish(const char *name) {
+    printf("%s: %d checks, %d failed\n", name, host_test_checks, host_test_failures);
+    return host_test_failures == 0 ? 0 : 1;
+}
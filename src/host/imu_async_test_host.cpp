@@ -0,0 +1,143 @@
+/**
+ * @file imu_async_test_host.cpp
+ * @brief Host test of the non-blocking IMU read on a fake bus with latency.
+ *
+ * Checked:
+ * - imu_read_raw_async() returns without spending bus time and the sample
+ *   arrives only when the completion interrupt runs, at the end of the bus
+ *   time plus the injected latency;
+ * - a second start while a transfer is in flight is refused without bus
+ *   traffic, and blocking reads fail until the transfer completes;
+ * - the busy flag is clear when the handler runs, so it can start the next
+ *   read;
+ * - error and no-acknowledge events complete with ok = false.
+ */
+
+#include "bsp/imu.hpp"
+#include "host_test.hpp"
+#include "lsm6dsl_mock.hpp"
+
+static const int16_t test_raw[IMU_RAW_WORDS] = { -300, 200, -100, 16384, -16384, 4096 };
+
+static int done_calls = 0;
+static bool done_ok = false;
+static bool done_busy = true;
+static uint64_t done_at_us = 0;
+static int16_t chained_raw[IMU_RAW_WORDS];
+static bool chain_next = false;
+static bool chain_started = false;
+
+static void read_done(bool ok) {
+    done_calls++;
+    done_ok = ok;
+    done_busy = imu_read_async_busy();
+    done_at_us = fake_mbed_now_us();
+    if (chain_next) {
+        chain_next = false;
+        chain_started = imu_read_raw_async(chained_raw, read_done);
+    }
+}
+
+static void reset_done() {
+    done_calls = 0;
+    done_ok = false;
+    done_busy = true;
+    done_at_us = 0;
+}
+
+static bool raw_equals(const int16_t *raw, const int16_t *expected) {
+    return memcmp(raw, expected, IMU_RAW_WORDS * sizeof(int16_t)) == 0;
+}
+
+static void test_latency(uint32_t latency_us) {
+    int16_t raw[IMU_RAW_WORDS];
+    memset(raw, 0x55, sizeof(raw));
+    reset_done();
+    lsm6dsl_mock_set_transfer_latency(latency_us);
+    lsm6dsl_mock_bus_clear();
+
+    uint64_t start_us = fake_mbed_now_us();
+    HOST_CHECK(imu_read_raw_async(raw, read_done));
+    HOST_CHECK(fake_mbed_now_us() == start_us);
+    HOST_CHECK(imu_read_async_busy());
+
+    // Address write + 12-byte read, as for the blocking burst.
+    lsm6dsl_mock_bus_t bus = lsm6dsl_mock_bus();
+    HOST_CHECK(bus.transactions == 2);
+    HOST_CHECK(bus.time_us == 345);
+    uint64_t end_us = start_us + bus.time_us + latency_us;
+
+    // In flight: no second transfer, no blocking access, no data yet.
+    int16_t other[IMU_RAW_WORDS];
+    HOST_CHECK(!imu_read_raw_async(other, read_done));
+    HOST_CHECK(lsm6dsl_mock_bus().transactions == 2);
+    HOST_CHECK(!imu_read_raw(other));
+    fake_mbed_advance_us(end_us - 1 - fake_mbed_now_us());
+    HOST_CHECK(done_calls == 0);
+    HOST_CHECK(imu_read_async_busy());
+
+    fake_mbed_advance_us(1);
+    HOST_CHECK(done_calls == 1);
+    HOST_CHECK(done_ok);
+    HOST_CHECK(!done_busy);
+    HOST_CHECK(done_at_us == end_us);
+    HOST_CHECK(raw_equals(raw, test_raw));
+    HOST_CHECK(!imu_read_async_busy());
+    printf("async read, latency %u us: started in 0 us, completed after %u us\n",
+        (unsigned)latency_us, (unsigned)(done_at_us - start_us));
+}
+
+static void test_chained() {
+    int16_t raw[IMU_RAW_WORDS];
+    reset_done();
+    lsm6dsl_mock_set_transfer_latency(0);
+    memset(chained_raw, 0, sizeof(chained_raw));
+    chain_next = true;
+    chain_started = false;
+    HOST_CHECK(imu_read_raw_async(raw, read_done));
+    fake_mbed_advance_us(1000);
+    HOST_CHECK(chain_started);
+    HOST_CHECK(done_calls == 2);
+    HOST_CHECK(raw_equals(chained_raw, test_raw));
+}
+
+static void test_errors() {
+    int16_t raw[IMU_RAW_WORDS];
+    lsm6dsl_mock_set_transfer_latency(50);
+
+    static const int events[] = {
+        I2C_EVENT_ERROR | I2C_EVENT_ERROR_NO_SLAVE,
+        I2C_EVENT_ERROR | I2C_EVENT_TRANSFER_EARLY_NACK,
+        I2C_EVENT_ERROR,
+    };
+    for (size_t i = 0; i < sizeof(events) / sizeof(events[0]); i++) {
+        reset_done();
+        done_ok = true;
+        lsm6dsl_mock_fail_next_transfer(events[i]);
+        HOST_CHECK(imu_read_raw_async(raw, read_done));
+        fake_mbed_advance_us(1000);
+        HOST_CHECK(done_calls == 1);
+        HOST_CHECK(!done_ok);
+        HOST_CHECK(!imu_read_async_busy());
+    }
+
+    // The bus works again afterwards.
+    reset_done();
+    HOST_CHECK(imu_read_raw_async(raw, read_done));
+    fake_mbed_advance_us(1000);
+    HOST_CHECK(done_ok);
+    HOST_CHECK(raw_equals(raw, test_raw));
+}
+
+int main() {
+    lsm6dsl_mock_reset();
+    HOST_CHECK(imu_init());
+    lsm6dsl_mock_set_output(test_raw);
+
+    test_latency(0);
+    test_latency(40);
+    test_latency(2000);
+    test_chained();
+    test_errors();
+    return host_test_finish("imu_async");
+}
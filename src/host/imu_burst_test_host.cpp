@@ -0,0 +1,113 @@
+/**
+ * @file imu_burst_test_host.cpp
+ * @brief Host test of the IMU BSP burst read against the LSM6DSL mock.
+ *
+ * Checked:
+ * - imu_init() verifies WHO_AM_I and leaves IF_INC set (the burst relies on
+ *   it), the bus at 400 kHz and the data-ready interrupt routed to INT1;
+ * - imu_read_raw() decodes the output block, including negative and extreme
+ *   values, and imu_read_data() scales it;
+ * - the burst is one address write plus one 12-byte read, and its bus time
+ *   at 400 kHz is below a third of twelve single-register reads;
+ * - the INT1 handler stamps the edge time and sets the data-ready flag.
+ */
+
+#include "bsp/imu.hpp"
+#include "host_test.hpp"
+#include "lsm6dsl_mock.hpp"
+
+// Single-register access, internal to the BSP.
+bool imu_read_reg(uint8_t reg, uint8_t &val);
+
+static const int16_t test_raw[IMU_RAW_WORDS] = { 1234, -1234, 32767, -32768, 1, -1 };
+
+static void test_init() {
+    lsm6dsl_mock_reset();
+    lsm6dsl_mock_set_reg(WHO_AM_I, 0x69);
+    HOST_CHECK(!imu_init());
+
+    lsm6dsl_mock_reset();
+    lsm6dsl_mock_set_reg(CTRL3_C, 0x00);
+    HOST_CHECK(imu_init());
+    HOST_CHECK(lsm6dsl_mock_frequency() == 400000);
+    HOST_CHECK((lsm6dsl_mock_reg(CTRL3_C) & 0x04) != 0);
+    HOST_CHECK(lsm6dsl_mock_reg(CTRL1_XL) == CTRL_ODR_208HZ);
+    HOST_CHECK(lsm6dsl_mock_reg(CTRL2_G) == CTRL_ODR_208HZ);
+    HOST_CHECK(lsm6dsl_mock_reg(INT1_CTRL) == INT1_CTRL_DRDY_XL);
+}
+
+static void test_decode() {
+    lsm6dsl_mock_set_output(test_raw);
+    int16_t raw[IMU_RAW_WORDS] = { 0 };
+    HOST_CHECK(imu_read_raw(raw));
+    for (int i = 0; i < IMU_RAW_WORDS; i++) {
+        HOST_CHECK(raw[i] == test_raw[i]);
+    }
+
+    float32_t acc[3];
+    float32_t gyro[3];
+    HOST_CHECK(imu_read_data(acc, gyro));
+    for (int i = 0; i < 3; i++) {
+        HOST_CHECK(gyro[i] == (float32_t)test_raw[IMU_RAW_GYRO + i] * IMU_GYRO_SCALE);
+        HOST_CHECK(acc[i] == (float32_t)test_raw[IMU_RAW_ACCEL + i] * IMU_ACC_SCALE);
+    }
+
+    // Without IF_INC the sensor returns the first register over and over:
+    // the burst only works because imu_init() sets it.
+    lsm6dsl_mock_set_reg(CTRL3_C, 0x40);
+    HOST_CHECK(imu_read_raw(raw));
+    HOST_CHECK(raw[0] != test_raw[0] || raw[1] != test_raw[1]);
+    lsm6dsl_mock_set_reg(CTRL3_C, 0x44);
+}
+
+static void test_bus_time() {
+    int16_t raw[IMU_RAW_WORDS];
+    lsm6dsl_mock_bus_clear();
+    uint64_t start_us = fake_mbed_now_us();
+    HOST_CHECK(imu_read_raw(raw));
+    lsm6dsl_mock_bus_t burst = lsm6dsl_mock_bus();
+
+    // Address write (repeated START) + 12-byte read: 19 + 119 clocks.
+    HOST_CHECK(burst.transactions == 2);
+    HOST_CHECK(burst.data_bytes == 1 + IMU_BURST_LEN);
+    HOST_CHECK(burst.clocks == 138);
+    HOST_CHECK(burst.time_us == 345);
+    HOST_CHECK(fake_mbed_now_us() - start_us == burst.time_us);
+
+    // The same six values register by register.
+    lsm6dsl_mock_bus_clear();
+    for (uint8_t reg = OUTX_L_G; reg <= OUTZ_H_XL; reg++) {
+        uint8_t val;
+        HOST_CHECK(imu_read_reg(reg, val));
+        HOST_CHECK(val == lsm6dsl_mock_reg(reg));
+    }
+    lsm6dsl_mock_bus_t single = lsm6dsl_mock_bus();
+    HOST_CHECK(single.transactions == 2 * IMU_BURST_LEN);
+    HOST_CHECK(single.clocks == IMU_BURST_LEN * 39);
+    HOST_CHECK(burst.time_us * 3 < single.time_us);
+
+    printf("burst read: %u us, %u transactions; per-register: %u us, %u transactions\n",
+        (unsigned)burst.time_us, (unsigned)burst.transactions,
+        (unsigned)single.time_us, (unsigned)single.transactions);
+}
+
+static void test_data_ready() {
+    imu_data_ready_clear();
+    HOST_CHECK(!imu_data_ready());
+    fake_mbed_advance_us(4807);
+    uint32_t edge_us = (uint32_t)fake_mbed_now_us();
+    fake_mbed_pin_rise(LSM6DSL_INT1_PIN);
+    fake_mbed_advance_us(100);
+    HOST_CHECK(imu_data_ready());
+    HOST_CHECK(imu_data_ready_time_us() == edge_us);
+    imu_data_ready_clear();
+    HOST_CHECK(!imu_data_ready());
+}
+
+int main() {
+    test_init();
+    test_decode();
+    test_bus_time();
+    test_data_ready();
+    return host_test_finish("imu_burst");
+}
@@ -0,0 +1,320 @@
+/**
+ * @file imu_fifo_test_host.cpp
+ * @brief Host test of the IMU FIFO path on the LSM6DSL mock's FIFO model.
+ *
+ * Checked:
+ * - imu_fifo_enable() flushes stale data and programs the watermark, which
+ *   then raises INT1;
+ * - imu_fifo_level() reports complete samples and realigns a read pointer
+ *   left inside a sample, also when the rest of that sample is not written
+ *   yet; imu_fifo_read() returns the samples in order;
+ * - an overrun is reported and the samples after it are intact;
+ * - imu_fifo_clock timestamps follow a simulated 208 Hz sensor within one
+ *   period, with exact spacing and one sequence number per sensor sample;
+ * - after an overrun the lost-sample estimate is within one sample of the
+ *   samples actually lost, and timestamps and numbering settle again;
+ * - a failed burst read numbers its samples without delivering them and
+ *   leaves the rest queued for the next batch.
+ *
+ * The batches run through imu_fifo_drain(), the step imu_task's FIFO loop
+ * uses.
+ */
+
+#include "bsp/imu.hpp"
+#include "imu_fifo_drain.hpp"
+#include "host_test.hpp"
+#include "lsm6dsl_mock.hpp"
+
+#define WORDS IMU_FIFO_WORDS_PER_SAMPLE
+
+// Block read, internal to the BSP.
+bool imu_read_regs(uint8_t reg, uint8_t *buf, int len);
+
+static uint32_t sensor_samples = 0;     // samples written by the simulated sensor
+static uint64_t sensor_start_us = 0;
+
+// Sample k: gyro x carries k, the other words k plus their pattern index.
+static void sensor_sample(uint32_t k, int16_t *words) {
+    for (int w = 0; w < WORDS; w++) {
+        words[w] = (int16_t)(k * 8 + (uint32_t)w);
+    }
+}
+
+static void sensor_push(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        int16_t words[WORDS];
+        sensor_sample(sensor_samples++, words);
+        lsm6dsl_mock_fifo_push(words, WORDS);
+    }
+}
+
+static uint64_t sensor_time_us(uint32_t k) {
+    return sensor_start_us + (uint64_t)k * 1000000 / IMU_SAMPLE_RATE_HZ;
+}
+
+// Let the simulated clock run and write every sample due by now.
+static void sensor_run_until(uint64_t now_us) {
+    if (fake_mbed_now_us() < now_us) {
+        fake_mbed_advance_us(now_us - fake_mbed_now_us());
+    }
+    while (sensor_time_us(sensor_samples) <= fake_mbed_now_us()) {
+        sensor_push(1);
+    }
+}
+
+static bool check_sample(const int16_t *raw, uint32_t k) {
+    int16_t words[WORDS];
+    sensor_sample(k, words);
+    return memcmp(raw, words, sizeof(words)) == 0;
+}
+
+static void test_enable() {
+    lsm6dsl_mock_reset();
+    HOST_CHECK(imu_init());
+    // Bypass mode: nothing is stored.
+    sensor_push(3);
+    HOST_CHECK(lsm6dsl_mock_fifo_words() == 0);
+
+    HOST_CHECK(imu_fifo_enable(10));
+    HOST_CHECK(lsm6dsl_mock_reg(FIFO_CTRL1) == 60);
+    HOST_CHECK(lsm6dsl_mock_reg(FIFO_CTRL2) == 0);
+    HOST_CHECK(lsm6dsl_mock_reg(FIFO_CTRL5) == FIFO_CTRL5_208HZ_CONTINUOUS);
+    HOST_CHECK(lsm6dsl_mock_reg(INT1_CTRL) == INT1_CTRL_FTH);
+
+    imu_data_ready_clear();
+    sensor_push(9);
+    HOST_CHECK(!imu_data_ready());
+    sensor_push(1);
+    HOST_CHECK(imu_data_ready());
+    imu_data_ready_clear();
+}
+
+static void test_level_and_read() {
+    bool overrun = true;
+    uint32_t first = sensor_samples - 10;
+    sensor_push(10);
+    HOST_CHECK(imu_fifo_level(&overrun) == 20);
+    HOST_CHECK(!overrun);
+
+    static int16_t batch[IMU_FIFO_READ_CHUNK][WORDS];
+    HOST_CHECK(imu_fifo_read(batch, 16));
+    for (uint32_t i = 0; i < 16; i++) {
+        HOST_CHECK(check_sample(batch[i], first + i));
+    }
+    HOST_CHECK(imu_fifo_level(&overrun) == 4);
+
+    // Two words of the next sample already read: the rest is skipped.
+    uint8_t words[4];
+    HOST_CHECK(imu_read_regs(FIFO_DATA_OUT_L, words, sizeof(words)));
+    HOST_CHECK(lsm6dsl_mock_reg(FIFO_STATUS3) == 0);
+    HOST_CHECK(imu_fifo_level(&overrun) == 3);
+    HOST_CHECK(lsm6dsl_mock_fifo_words() == 3 * WORDS);
+    HOST_CHECK(imu_fifo_read(batch, 3));
+    for (uint32_t i = 0; i < 3; i++) {
+        HOST_CHECK(check_sample(batch[i], first + 17 + i));
+    }
+    HOST_CHECK(imu_fifo_level(&overrun) == 0);
+}
+
+static void test_partial_sample() {
+    bool overrun;
+    int16_t words[WORDS];
+    sensor_sample(sensor_samples++, words);
+
+    // Gyro written, accel not yet; two gyro words already read.
+    lsm6dsl_mock_fifo_push(words, 3);
+    uint8_t discard[4];
+    HOST_CHECK(imu_read_regs(FIFO_DATA_OUT_L, discard, sizeof(discard)));
+    HOST_CHECK(imu_fifo_level(&overrun) == 0);
+    HOST_CHECK(lsm6dsl_mock_fifo_words() == 1);
+
+    // Accel arrives: the partial sample is dropped, the next one is whole.
+    lsm6dsl_mock_fifo_push(&words[3], 3);
+    sensor_push(1);
+    HOST_CHECK(imu_fifo_level(&overrun) == 1);
+    int16_t raw[1][WORDS];
+    HOST_CHECK(imu_fifo_read(raw, 1));
+    HOST_CHECK(check_sample(raw[0], sensor_samples - 1));
+}
+
+static void test_overrun() {
+    bool overrun = false;
+    // 342 samples are 2052 words: the oldest four words are overwritten and
+    // the read side starts at word 4 of sample `first`. The level reads as
+    // 2047 words; after skipping two, 340 whole samples remain.
+    uint32_t first = sensor_samples;
+    sensor_push(LSM6DSL_MOCK_FIFO_WORDS / WORDS + 1);
+    HOST_CHECK(lsm6dsl_mock_fifo_words() == LSM6DSL_MOCK_FIFO_WORDS);
+    int level = imu_fifo_level(&overrun);
+    HOST_CHECK(overrun);
+    HOST_CHECK(level == (0x7FF - 2) / WORDS);
+
+    static int16_t batch[IMU_FIFO_READ_CHUNK][WORDS];
+    HOST_CHECK(imu_fifo_read(batch, 2));
+    HOST_CHECK(check_sample(batch[0], first + 1));
+    HOST_CHECK(check_sample(batch[1], first + 2));
+    imu_fifo_level(&overrun);
+    HOST_CHECK(!overrun);
+
+    // Drain the rest.
+    while ((level = imu_fifo_level(&overrun)) > 0) {
+        int count = level < IMU_FIFO_READ_CHUNK ? level : IMU_FIFO_READ_CHUNK;
+        HOST_CHECK(imu_fifo_read(batch, count));
+    }
+}
+
+// imu_fifo_loop() state, and what it delivered since the last phase_reset().
+typedef struct {
+    imu_fifo_clock_t clock;
+    uint32_t seq;           // sequence number of the last sample
+    uint32_t last_us;       // timestamp of the last sample
+    uint32_t last_k;        // sensor index of the last sample
+    imu_fifo_batch_t batch; // last batch
+    // Per phase:
+    uint32_t samples;
+    uint32_t max_error_us;  // |timestamp - sensor sample time|
+    bool spacing_ok;        // 1/ODR between consecutive timestamps
+    bool seq_ok;            // seq - k constant
+    bool content_ok;
+    int32_t seq_offset;     // seq - (k + 1) of the first sample
+} reader_t;
+
+static reader_t reader;
+
+static void phase_reset() {
+    reader.samples = 0;
+    reader.max_error_us = 0;
+    reader.spacing_ok = true;
+    reader.seq_ok = true;
+    reader.content_ok = true;
+}
+
+// imu_fifo_drain() sink: check one sample against the simulated sensor.
+static void reader_sample(const int16_t *raw, uint32_t sample_us, uint32_t seq) {
+    uint32_t k = (uint32_t)raw[0] / 8;
+    int32_t offset = (int32_t)(seq - (k + 1));
+    if (reader.samples == 0) {
+        reader.seq_offset = offset;
+    } else {
+        uint32_t spacing = sample_us - reader.last_us;
+        if (spacing != 4807 && spacing != 4808) reader.spacing_ok = false;
+        if (offset != reader.seq_offset) reader.seq_ok = false;
+    }
+    if (!check_sample(raw, k)) reader.content_ok = false;
+    int32_t error = (int32_t)(sample_us - (uint32_t)sensor_time_us(k));
+    uint32_t abs_error = error < 0 ? (uint32_t)-error : (uint32_t)error;
+    if (abs_error > reader.max_error_us) reader.max_error_us = abs_error;
+    reader.samples++;
+    reader.last_us = sample_us;
+    reader.last_k = k;
+}
+
+// One imu_fifo_loop() activation.
+static void reader_batch() {
+    imu_fifo_drain(&reader.clock, &reader.seq, reader_sample, &reader.batch);
+    if (reader.batch.read_failed == 0) {
+        HOST_CHECK(reader.batch.available < 0 || reader.batch.delivered == (uint32_t)reader.batch.available);
+    }
+}
+
+// Watermark wakeup with a little scheduling delay.
+static void reader_wake(int wake, uint64_t extra_delay_us) {
+    uint32_t due = sensor_samples + IMU_FIFO_WATERMARK_SAMPLES;
+    sensor_run_until(sensor_time_us(due - 1) + 150 + (uint64_t)(wake % 5) * 40 + extra_delay_us);
+    reader_batch();
+}
+
+static void test_clock() {
+    const uint32_t period_us = 1000000 / IMU_SAMPLE_RATE_HZ;
+
+    lsm6dsl_mock_reset();
+    HOST_CHECK(imu_init());
+    HOST_CHECK(imu_fifo_enable(IMU_FIFO_WATERMARK_SAMPLES));
+    sensor_samples = 0;
+    sensor_start_us = fake_mbed_now_us() + 1000;
+
+    memset(&reader, 0, sizeof(reader));
+    imu_fifo_clock_init(&reader.clock, IMU_SAMPLE_RATE_HZ);
+
+    // Normal operation: exact spacing, every sample numbered, each stamped
+    // within one period of its sensor time.
+    phase_reset();
+    for (int wake = 0; wake < 20; wake++) {
+        reader_wake(wake, 0);
+    }
+    HOST_CHECK(reader.samples == 20 * IMU_FIFO_WATERMARK_SAMPLES);
+    HOST_CHECK(reader.spacing_ok);
+    HOST_CHECK(reader.seq_ok);
+    HOST_CHECK(reader.seq_offset == 0);
+    HOST_CHECK(reader.content_ok);
+    HOST_CHECK(reader.max_error_us < period_us);
+    printf("clock: max timestamp error %u us\n", (unsigned)reader.max_error_us);
+
+    // A 2.5 s stall overflows the FIFO. The estimate is at most one sample
+    // off the samples actually lost (the newest sample may still be partly
+    // written, or its last word beyond the 11-bit level).
+    uint32_t last_k = reader.last_k;
+    phase_reset();
+    reader_wake(20, 2500000);
+    uint32_t first_k = reader.last_k - (reader.samples - 1);
+    uint32_t lost = first_k - last_k - 1;
+    HOST_CHECK(lost > 0);
+    HOST_CHECK(reader.batch.lost + 1 >= lost && reader.batch.lost <= lost + 1);
+    HOST_CHECK(reader.content_ok);
+    HOST_CHECK(reader.spacing_ok);
+    HOST_CHECK(reader.max_error_us < 2 * period_us);
+    printf("overrun: %u samples lost, %u estimated\n", (unsigned)lost, (unsigned)reader.batch.lost);
+
+    // Afterwards the clock re-anchors on drift if needed, and the numbering
+    // keeps whatever offset the estimate left.
+    for (int wake = 21; wake < 30; wake++) {
+        reader_wake(wake, 0);
+    }
+    int32_t offset = reader.seq_offset;
+    HOST_CHECK(offset >= -1 && offset <= 1);
+    phase_reset();
+    for (int wake = 30; wake < 40; wake++) {
+        reader_wake(wake, 0);
+    }
+    HOST_CHECK(reader.samples >= 10 * IMU_FIFO_WATERMARK_SAMPLES - 1);
+    HOST_CHECK(reader.spacing_ok);
+    HOST_CHECK(reader.seq_ok);
+    HOST_CHECK(reader.seq_offset == offset);
+    HOST_CHECK(reader.content_ok);
+    HOST_CHECK(reader.max_error_us < period_us);
+
+    // A burst read fails on the last word of its chunk: those samples are
+    // numbered but not delivered, and the rest of the batch stays queued
+    // behind the word left over.
+    uint32_t seq = reader.seq;
+    phase_reset();
+    lsm6dsl_mock_fail_next_read(IMU_FIFO_READ_CHUNK * WORDS * 2 - 2);
+    reader_wake(40, 0);
+    HOST_CHECK(reader.batch.available == IMU_FIFO_WATERMARK_SAMPLES);
+    HOST_CHECK(reader.batch.read_failed == IMU_FIFO_READ_CHUNK);
+    HOST_CHECK(reader.batch.delivered == 0);
+    HOST_CHECK(reader.samples == 0);
+    HOST_CHECK(reader.seq == seq + IMU_FIFO_READ_CHUNK);
+    HOST_CHECK(lsm6dsl_mock_fifo_words() == (IMU_FIFO_WATERMARK_SAMPLES - IMU_FIFO_READ_CHUNK) * WORDS + 1);
+
+    // The next batch re-anchors; the skipped samples are already numbered,
+    // so the numbering keeps its offset.
+    for (int wake = 41; wake < 45; wake++) {
+        reader_wake(wake, 0);
+        HOST_CHECK(reader.batch.lost == 0);
+    }
+    HOST_CHECK(reader.seq_ok);
+    HOST_CHECK(reader.seq_offset == offset);
+    HOST_CHECK(reader.spacing_ok);
+    HOST_CHECK(reader.content_ok);
+    HOST_CHECK(reader.max_error_us < period_us);
+}
+
+int main() {
+    test_enable();
+    test_level_and_read();
+    test_partial_sample();
+    test_overrun();
+    test_clock();
+    return host_test_finish("imu_fifo");
+}
@@ -0,0 +1,304 @@
+/**
+ * @file lsm6dsl_mock.cpp
+ * @brief Implementation of the LSM6DSL register model and the fake I2C bus.
+ */
+
+#include "lsm6dsl_mock.hpp"
+#include "bsp/imu.hpp"
+#include "mbed.h"
+
+#define MOCK_REG_COUNT  0x80
+#define MOCK_IF_INC     0x04
+#define MOCK_BITS_BYTE  9   // 8 data bits + ACK
+
+#define MOCK_BUS_BUSY   -2  // I2C_ERROR_BUS_BUSY
+
+// In-flight transfer(): its buffers and completion, run at `done_us`.
+typedef struct {
+    bool active;
+    const char *tx;
+    int tx_length;
+    char *rx;
+    int rx_length;
+    event_callback_t callback;
+    int event_mask;
+} mock_async_t;
+
+static uint8_t mock_regs[MOCK_REG_COUNT];
+static uint8_t mock_pointer = 0;
+static uint32_t mock_frequency = 100000;    // Mbed default
+static lsm6dsl_mock_bus_t mock_bus;
+static mock_async_t mock_async;
+static uint32_t mock_transfer_latency_us = 0;
+static int mock_transfer_fail_event = 0;
+static int mock_read_fail_after = -1;
+static uint64_t mock_bus_ns = 0;
+
+// FIFO ring; the pattern is that of the oldest word.
+static int16_t mock_fifo[LSM6DSL_MOCK_FIFO_WORDS];
+static uint32_t mock_fifo_head = 0;
+static uint32_t mock_fifo_count = 0;
+static uint32_t mock_fifo_pattern = 0;
+static bool mock_fifo_overrun = false;
+
+void lsm6dsl_mock_reset() {
+    memset(mock_regs, 0, sizeof(mock_regs));
+    mock_regs[WHO_AM_I] = 0x6A;
+    mock_regs[CTRL3_C] = MOCK_IF_INC;
+    mock_pointer = 0;
+    mock_frequency = 100000;
+    mock_fifo_head = 0;
+    mock_fifo_count = 0;
+    mock_fifo_pattern = 0;
+    mock_fifo_overrun = false;
+    mock_async.active = false;
+    mock_transfer_latency_us = 0;
+    mock_transfer_fail_event = 0;
+    mock_read_fail_after = -1;
+    lsm6dsl_mock_bus_clear();
+}
+
+uint8_t lsm6dsl_mock_reg(uint8_t reg) {
+    return mock_regs[reg % MOCK_REG_COUNT];
+}
+
+void lsm6dsl_mock_set_reg(uint8_t reg, uint8_t value) {
+    mock_regs[reg % MOCK_REG_COUNT] = value;
+}
+
+void lsm6dsl_mock_set_output(const int16_t *raw) {
+    for (int i = 0; i < IMU_RAW_WORDS; i++) {
+        mock_regs[OUTX_L_G + i * 2] = (uint8_t)(raw[i] & 0xFF);
+        mock_regs[OUTX_L_G + i * 2 + 1] = (uint8_t)((uint16_t)raw[i] >> 8);
+    }
+}
+
+lsm6dsl_mock_bus_t lsm6dsl_mock_bus() {
+    return mock_bus;
+}
+
+void lsm6dsl_mock_bus_clear() {
+    memset(&mock_bus, 0, sizeof(mock_bus));
+    mock_bus_ns = 0;
+}
+
+uint32_t lsm6dsl_mock_frequency() {
+    return mock_frequency;
+}
+
+void lsm6dsl_mock_set_transfer_latency(uint32_t latency_us) {
+    mock_transfer_latency_us = latency_us;
+}
+
+void lsm6dsl_mock_fail_next_transfer(int event) {
+    mock_transfer_fail_event = event;
+}
+
+void lsm6dsl_mock_fail_next_read(int after_bytes) {
+    mock_read_fail_after = after_bytes;
+}
+
+static void mock_fifo_pop() {
+    mock_fifo_head = (mock_fifo_head + 1) % LSM6DSL_MOCK_FIFO_WORDS;
+    mock_fifo_count--;
+    mock_fifo_pattern = (mock_fifo_pattern + 1) % IMU_FIFO_WORDS_PER_SAMPLE;
+}
+
+static uint32_t mock_fifo_watermark() {
+    return ((uint32_t)(mock_regs[FIFO_CTRL2] & 0x07) << 8) | mock_regs[FIFO_CTRL1];
+}
+
+void lsm6dsl_mock_fifo_push(const int16_t *words, int count) {
+    if ((mock_regs[FIFO_CTRL5] & 0x07) == 0) return;
+    uint32_t watermark = mock_fifo_watermark();
+    bool below = mock_fifo_count < watermark;
+    for (int i = 0; i < count; i++) {
+        if (mock_fifo_count == LSM6DSL_MOCK_FIFO_WORDS) {
+            // Continuous mode: the newest word replaces the oldest.
+            mock_fifo_pop();
+            mock_fifo_overrun = true;
+        }
+        mock_fifo[(mock_fifo_head + mock_fifo_count) % LSM6DSL_MOCK_FIFO_WORDS] = words[i];
+        mock_fifo_count++;
+    }
+    if (below && watermark > 0 && mock_fifo_count >= watermark && (mock_regs[INT1_CTRL] & INT1_CTRL_FTH)) {
+        fake_mbed_pin_rise(LSM6DSL_INT1_PIN);
+    }
+}
+
+uint32_t lsm6dsl_mock_fifo_words() {
+    return mock_fifo_count;
+}
+
+// DIFF_FIFO is 11 bits wide: a full FIFO reads as 2047 words.
+static uint32_t mock_fifo_level() {
+    return mock_fifo_count < 0x7FF ? mock_fifo_count : 0x7FF;
+}
+
+// Register value as seen on the bus; FIFO registers are computed and
+// reading the data high byte pops the word.
+static uint8_t mock_read_byte(uint8_t reg) {
+    switch (reg) {
+        case FIFO_STATUS1:
+            return (uint8_t)(mock_fifo_level() & 0xFF);
+        case FIFO_STATUS2:
+            return (uint8_t)(((mock_fifo_level() >> 8) & 0x07) |
+                (mock_fifo_overrun ? FIFO_STATUS2_OVER_RUN : 0) |
+                (mock_fifo_count == 0 ? 0x10 : 0) |
+                (mock_fifo_count >= mock_fifo_watermark() ? 0x80 : 0));
+        case FIFO_STATUS3:
+            return (uint8_t)(mock_fifo_pattern & 0xFF);
+        case FIFO_STATUS4:
+            return (uint8_t)((mock_fifo_pattern >> 8) & 0x03);
+        case FIFO_DATA_OUT_L:
+            return mock_fifo_count ? (uint8_t)(mock_fifo[mock_fifo_head] & 0xFF) : 0;
+        case FIFO_DATA_OUT_L + 1: {
+            if (mock_fifo_count == 0) return 0;
+            uint8_t high = (uint8_t)((uint16_t)mock_fifo[mock_fifo_head] >> 8);
+            mock_fifo_pop();
+            mock_fifo_overrun = false;
+            return high;
+        }
+        default:
+            return mock_regs[reg];
+    }
+}
+
+// Charge one transaction and return its duration (us); blocking callers wait
+// for it on the simulated clock.
+static uint32_t mock_bus_charge(int length, bool repeated, bool blocking) {
+    uint32_t clocks = 1 + MOCK_BITS_BYTE + MOCK_BITS_BYTE * (uint32_t)length + (repeated ? 0 : 1);
+    uint32_t before_us = (uint32_t)(mock_bus_ns / 1000);
+    mock_bus.transactions++;
+    mock_bus.data_bytes += (uint32_t)length;
+    mock_bus.clocks += clocks;
+    mock_bus_ns += (uint64_t)clocks * 1000000000u / mock_frequency;
+    mock_bus.time_us = (uint32_t)(mock_bus_ns / 1000);
+    if (blocking) {
+        fake_mbed_advance_us(mock_bus.time_us - before_us);
+    }
+    return mock_bus.time_us - before_us;
+}
+
+// Output and status registers are read-only.
+static bool mock_reg_writable(uint8_t reg) {
+    return reg != WHO_AM_I && (reg < WAKE_UP_SRC || reg > FIFO_DATA_OUT_L + 1);
+}
+
+static void mock_pointer_advance() {
+    if (!(mock_regs[CTRL3_C] & MOCK_IF_INC)) return;
+    if (mock_pointer == FIFO_DATA_OUT_L + 1) {
+        mock_pointer = FIFO_DATA_OUT_L;
+    } else {
+        mock_pointer = (uint8_t)((mock_pointer + 1) % MOCK_REG_COUNT);
+    }
+}
+
+static void mock_reg_write(uint8_t reg, uint8_t value) {
+    if (!mock_reg_writable(reg)) return;
+    mock_regs[reg] = value;
+    if (reg == FIFO_CTRL5 && (value & 0x07) == 0) {
+        // Bypass mode empties the FIFO.
+        mock_fifo_head = 0;
+        mock_fifo_count = 0;
+        mock_fifo_pattern = 0;
+        mock_fifo_overrun = false;
+    }
+}
+
+I2C::I2C(PinName sda, PinName scl) {
+    (void)sda;
+    (void)scl;
+}
+
+void I2C::frequency(int hz) {
+    mock_frequency = (uint32_t)hz;
+}
+
+int I2C::write(int address, const char *data, int length, bool repeated) {
+    if (mock_async.active) return MOCK_BUS_BUSY;
+    if (address != LSM6DSL_ADDR) {
+        mock_bus_charge(0, false, true);
+        return -1;
+    }
+    mock_bus_charge(length, repeated, true);
+    if (length == 0) return 0;
+    mock_pointer = (uint8_t)data[0] % MOCK_REG_COUNT;
+    for (int i = 1; i < length; i++) {
+        mock_reg_write(mock_pointer, (uint8_t)data[i]);
+        mock_pointer_advance();
+    }
+    return 0;
+}
+
+int I2C::read(int address, char *data, int length, bool repeated) {
+    if (mock_async.active) return MOCK_BUS_BUSY;
+    if (address != LSM6DSL_ADDR) {
+        mock_bus_charge(0, false, true);
+        return -1;
+    }
+    bool fail = mock_read_fail_after >= 0 && mock_read_fail_after < length;
+    if (fail) {
+        length = mock_read_fail_after;
+        mock_read_fail_after = -1;
+    }
+    mock_bus_charge(length, repeated, true);
+    for (int i = 0; i < length; i++) {
+        data[i] = (char)mock_read_byte(mock_pointer);
+        mock_pointer_advance();
+    }
+    return fail ? -1 : 0;
+}
+
+// End of a transfer() (interrupt context): the bytes move now.
+static void mock_transfer_complete(int event) {
+    if (event & I2C_EVENT_TRANSFER_COMPLETE) {
+        if (mock_async.tx_length > 0) {
+            mock_pointer = (uint8_t)mock_async.tx[0] % MOCK_REG_COUNT;
+            for (int i = 1; i < mock_async.tx_length; i++) {
+                mock_reg_write(mock_pointer, (uint8_t)mock_async.tx[i]);
+                mock_pointer_advance();
+            }
+        }
+        for (int i = 0; i < mock_async.rx_length; i++) {
+            mock_async.rx[i] = (char)mock_read_byte(mock_pointer);
+            mock_pointer_advance();
+        }
+    }
+    mock_async.active = false;
+    if (mock_async.callback && (event & mock_async.event_mask)) {
+        mock_async.callback(event & mock_async.event_mask);
+    }
+}
+
+int I2C::transfer(int address, const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length,
+                  const event_callback_t &callback, int event, bool repeated) {
+    if (mock_async.active) return -1;
+
+    int result = I2C_EVENT_TRANSFER_COMPLETE;
+    uint32_t duration_us;
+    if (address != LSM6DSL_ADDR) {
+        result = I2C_EVENT_ERROR | I2C_EVENT_ERROR_NO_SLAVE;
+        duration_us = mock_bus_charge(0, false, false);
+    } else if (mock_transfer_fail_event) {
+        result = mock_transfer_fail_event;
+        mock_transfer_fail_event = 0;
+        duration_us = mock_bus_charge(0, false, false);
+    } else {
+        duration_us = mock_bus_charge(tx_length, rx_length > 0, false);
+        if (rx_length > 0) {
+            duration_us += mock_bus_charge(rx_length, repeated, false);
+        }
+    }
+
+    mock_async.active = true;
+    mock_async.tx = tx_buffer;
+    mock_async.tx_length = tx_length;
+    mock_async.rx = rx_buffer;
+    mock_async.rx_length = rx_length;
+    mock_async.callback = callback;
+    mock_async.event_mask = event;
+    fake_mbed_schedule(fake_mbed_now_us() + duration_us + mock_transfer_latency_us,
+                       [result] { mock_transfer_complete(result); });
+    return 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+/**
+ * @file lsm6dsl_mock.hpp
+ * @brief Register-level LSM6DSL model on the fake I2C bus (host tests).
+ *
+ * The mock answers the fake mbed::I2C at LSM6DSL_ADDR like the sensor does:
+ * a write sets the register pointer (first byte) and stores the rest, a read
+ * returns bytes from the pointer, and the pointer advances after each byte
+ * only while IF_INC is set in CTRL3_C. Registers start at their power-on
+ * values (WHO_AM_I = 0x6A, CTRL3_C = IF_INC).
+ *
+ * The FIFO holds LSM6DSL_MOCK_FIFO_WORDS 16-bit words in continuous mode: a
+ * full FIFO drops its oldest word per new one and sets OVER_RUN, so an
+ * overrun can leave the read side in the middle of a sample (the FIFO size
+ * is not a multiple of six words). FIFO_STATUS1..4 report the level, the
+ * flags and the pattern (word index in the sample) of the next word to read
+ * (the 11-bit level saturates at 2047 words when the FIFO is full);
+ * FIFO_DATA_OUT_L/H pop one word, and auto-increment rolls back from the high
+ * to the low byte. Samples are only stored while FIFO_CTRL5 selects a FIFO
+ * mode; selecting bypass empties the FIFO. Crossing the watermark raises a
+ * rising edge on INT1 if INT1_CTRL routes it there.
+ *
+ * Every transaction is charged its bus time at the frequency set with
+ * I2C::frequency(): START, the address byte and each data byte (8 bits plus
+ * ACK), and STOP unless a repeated START follows. Blocking transactions
+ * advance the simulated clock by that time, since the calling thread waits
+ * for the bus.
+ *
+ * I2C::transfer() runs the same transaction without blocking: the bytes move
+ * and the callback runs from a scheduled interrupt at the end of its bus time
+ * plus an injectable latency. While it is in flight another transfer() fails
+ * and blocking calls return the bus-busy error.
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief FIFO capacity in 16-bit words (4 KB).
+ */
+#define LSM6DSL_MOCK_FIFO_WORDS 2048
+
+/**
+ * @brief Bus activity since the last lsm6dsl_mock_bus_clear().
+ */
+typedef struct {
+    uint32_t transactions;  /**< Address phases (START or repeated START). */
+    uint32_t data_bytes;    /**< Bytes after the address byte. */
+    uint32_t clocks;        /**< SCL periods, including START and STOP. */
+    uint32_t time_us;       /**< Bus time at the configured frequency. */
+} lsm6dsl_mock_bus_t;
+
+/**
+ * @brief Power-on reset: registers to defaults, bus statistics cleared.
+ */
+void lsm6dsl_mock_reset();
+
+/**
+ * @brief Read a register without a bus transaction.
+ */
+uint8_t lsm6dsl_mock_reg(uint8_t reg);
+
+/**
+ * @brief Set a register without a bus transaction (read-only ones included).
+ */
+void lsm6dsl_mock_set_reg(uint8_t reg, uint8_t value);
+
+/**
+ * @brief Load the output block (OUTX_L_G..OUTZ_H_XL).
+ * @param raw Gyro x/y/z, then accel x/y/z.
+ */
+void lsm6dsl_mock_set_output(const int16_t *raw);
+
+/**
+ * @brief Bus statistics since the last clear.
+ */
+lsm6dsl_mock_bus_t lsm6dsl_mock_bus();
+
+/**
+ * @brief Reset the bus statistics.
+ */
+void lsm6dsl_mock_bus_clear();
+
+/**
+ * @brief Bus frequency last set with I2C::frequency() (Hz).
+ */
+uint32_t lsm6dsl_mock_frequency();
+
+/**
+ * @brief Sensor writes `count` words to the FIFO (six per full sample,
+ *        gyro x/y/z then accel x/y/z).
+ */
+void lsm6dsl_mock_fifo_push(const int16_t *words, int count);
+
+/**
+ * @brief Words currently in the FIFO.
+ */
+uint32_t lsm6dsl_mock_fifo_words();
+
+/**
+ * @brief Extra delay between the end of a transfer() and its completion
+ *        interrupt (clock stretching, interrupt latency).
+ */
+void lsm6dsl_mock_set_transfer_latency(uint32_t latency_us);
+
+/**
+ * @brief Make the next transfer() complete with `event` (I2C_EVENT_ERROR...)
+ *        instead of moving data.
+ */
+void lsm6dsl_mock_fail_next_transfer(int event);
+
+/**
+ * @brief Make the next blocking read() longer than `after_bytes` fail with a
+ *        bus error after moving `after_bytes` bytes (FIFO words read up to
+ *        then are dequeued). Shorter reads succeed.
+ */
+void lsm6dsl_mock_fail_next_read(int after_bytes);
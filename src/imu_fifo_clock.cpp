@@ -0,0 +1,53 @@
+/**
+ * @file imu_fifo_clock.cpp
+ * @brief Implementation of the IMU FIFO sample clock.
+ */
+
+#include "imu_fifo_clock.hpp"
+
+// Offset of the k-th sample after the anchor, modulo 2^32 us.
+static uint32_t imu_fifo_clock_offset_us(const imu_fifo_clock_t *clock, uint32_t k) {
+    return (uint32_t)((uint64_t)k * 1000000 / clock->rate_hz);
+}
+
+void imu_fifo_clock_init(imu_fifo_clock_t *clock, uint32_t rate_hz) {
+    clock->rate_hz = rate_hz;
+    clock->period_us = 1000000 / rate_hz;
+    clock->anchor_us = 0;
+    clock->sample_index = 0;
+    clock->anchored = false;
+    clock->lost_data = false;
+}
+
+uint32_t imu_fifo_clock_batch(imu_fifo_clock_t *clock, uint32_t now_us, uint32_t available) {
+    int32_t period = (int32_t)clock->period_us;
+    uint32_t newest_us = clock->anchor_us + imu_fifo_clock_offset_us(clock, clock->sample_index + available - 1);
+    int32_t drift_us = (int32_t)(now_us - newest_us);
+    if (clock->anchored && !clock->lost_data && drift_us <= period && drift_us >= -period) {
+        return 0;
+    }
+
+    uint32_t new_anchor_us = now_us - imu_fifo_clock_offset_us(clock, available - 1);
+    uint32_t lost = 0;
+    if (clock->anchored && clock->lost_data) {
+        // Slots between the next expected sample and the new anchor.
+        int32_t gap_us = (int32_t)(new_anchor_us - (clock->anchor_us + imu_fifo_clock_offset_us(clock, clock->sample_index)));
+        if (gap_us > period / 2) {
+            lost = ((uint32_t)gap_us + clock->period_us / 2) / clock->period_us;
+        }
+    }
+    clock->anchor_us = new_anchor_us;
+    clock->sample_index = 0;
+    clock->anchored = true;
+    clock->lost_data = false;
+    return lost;
+}
+
+uint32_t imu_fifo_clock_next(imu_fifo_clock_t *clock) {
+    return clock->anchor_us + imu_fifo_clock_offset_us(clock, clock->sample_index++);
+}
+
+void imu_fifo_clock_lost(imu_fifo_clock_t *clock, uint32_t skipped) {
+    clock->sample_index += skipped;
+    clock->lost_data = true;
+}
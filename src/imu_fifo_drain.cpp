@@ -0,0 +1,46 @@
+/**
+ * @file imu_fifo_drain.cpp
+ * @brief Implementation of the FIFO-mode batch drain.
+ */
+
+#include "imu_fifo_drain.hpp"
+#include "hal/us_ticker_api.h"
+
+void imu_fifo_drain(imu_fifo_clock_t *clock, uint32_t *seq, imu_fifo_sink_t sink, imu_fifo_batch_t *batch) {
+    static int16_t raw[IMU_FIFO_READ_CHUNK][IMU_FIFO_WORDS_PER_SAMPLE];
+
+    batch->overrun = false;
+    batch->lost = 0;
+    batch->read_failed = 0;
+    batch->delivered = 0;
+    batch->available = imu_fifo_level(&batch->overrun);
+    if (batch->available <= 0) {
+        return;
+    }
+    if (batch->overrun) {
+        imu_fifo_clock_lost(clock, 0);
+    }
+
+    // Map the newest queued sample to "now" and account for lost slots.
+    batch->lost = imu_fifo_clock_batch(clock, us_ticker_read(), (uint32_t)batch->available);
+    *seq += batch->lost;
+
+    int remaining = batch->available;
+    while (remaining > 0) {
+        int count = remaining < IMU_FIFO_READ_CHUNK ? remaining : IMU_FIFO_READ_CHUNK;
+        if (!imu_fifo_read(raw, count)) {
+            batch->read_failed = (uint32_t)count;
+            *seq += (uint32_t)count;
+            imu_fifo_clock_lost(clock, (uint32_t)count);
+            return;
+        }
+        remaining -= count;
+
+        for (int i = 0; i < count; i++) {
+            uint32_t sample_us = imu_fifo_clock_next(clock);
+            (*seq)++;
+            sink(raw[i], sample_us, *seq);
+            batch->delivered++;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ * @file latency.cpp
+ * @brief Implementation of the sample-to-output latency histograms.
+ */
+
+#define LOG_MODULE LOG_MODULE_TEST
+
+#include "latency.hpp"
+#include "mbed.h"
+#include "hal/us_ticker_api.h"
+#include "logger.hpp"
+#include "motion_status.hpp"
+#include "profiler.hpp"
+
+static const char *latency_stage_names[LATENCY_COUNT] = {
+    "sample->spectrum",
+    "spectrum->decision",
+    "sample->decision",
+    "decision->led",
+    "decision->ble",
+    "sample->led",
+    "sample->ble",
+};
+
+static profile_stats_t latency_stats[LATENCY_COUNT];
+static_assert(sizeof(latency_stats) == LATENCY_STATS_BYTES, "update LATENCY_STATS_BYTES");
+void latency_init() {
+    for (int i = 0; i < LATENCY_COUNT; i++) {
+        profile_stats_reset(&latency_stats[i]);
+    }
+}
+
+void latency_record(latency_stage_t stage, uint32_t start_us, uint32_t end_us) {
+    profile_stats_add(&latency_stats[stage], end_us - start_us);
+}
+
+void latency_record_output(latency_stage_t decision_stage, latency_stage_t sample_stage, uint32_t generation) {
+    motion_status_trace_t trace;
+    if (!motion_status_get_trace(generation, &trace)) {
+        return;
+    }
+    uint32_t now_us = us_ticker_read();
+    latency_record(decision_stage, trace.decision_time_us, now_us);
+    latency_record(sample_stage, trace.sample_time_us, now_us);
+}
+
+void latency_report() {
+    for (int i = 0; i < LATENCY_COUNT; i++) {
+        profile_stats_t stats = latency_stats[i];
+        profile_stats_reset(&latency_stats[i]);
+        profile_stats_log("Latency", latency_stage_names[i], &stats, "us");
+    }
+}
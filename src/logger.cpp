@@ -6,10 +6,16 @@
 #include "logger.hpp"
 #include "mbed.h"
 #include "bsp/serial.hpp"
+#ifdef LOG_DEFERRED
+#include "hal/us_ticker_api.h"
+#endif
 
 // Global log level (default: INFO).
 LogLevel_t g_log_level = LOG_LEVEL_INFO;
 
+// Per-module levels (default: DEBUG, so only the global level filters).
+LogLevel_t g_log_module_levels[LOG_MODULE_COUNT];
+
 // Level names (fixed width helps align logs).
 static const char* log_level_strings[] = {
     "DEBUG",
@@ -45,6 +51,27 @@ void log_set_level(LogLevel_t level) {
     g_log_level = level;
 }
 
+// Set one module's log level.
+void log_set_module_level(LogModule_t module, LogLevel_t level) {
+    if (module < LOG_MODULE_COUNT) {
+        g_log_module_levels[module] = level;
+    }
+}
+
+// Log header: [sec.msec] [LEVEL] [thread_name] (caller holds the serial lock).
+static void log_print_header(LogLevel_t level, uint64_t ms_total, const char *thread_name) {
+    unsigned long seconds = static_cast<unsigned long>(ms_total / 1000);
+    unsigned long milliseconds = static_cast<unsigned long>(ms_total % 1000);
+
+    printf("%s[%5lu.%03lu] [%s] [%-15s]%s ",
+            log_level_colors[level],
+            seconds,
+            milliseconds,
+            log_level_strings[level],
+            thread_name,
+            log_level_colors_reset);
+}
+
 // Core log print function (thread-safe via serial lock).
 void log_print(LogLevel_t level, const char* format, ...) {
     // Filter out messages below the configured level.
@@ -57,17 +84,7 @@ void log_print(LogLevel_t level, const char* format, ...) {
     // Timestamp from RTOS kernel clock.
     auto now = Kernel::Clock::now().time_since_epoch();
     uint64_t ms_total = chrono::duration_cast<chrono::milliseconds>(now).count();
-    unsigned long seconds = static_cast<unsigned long>(ms_total / 1000);
-    unsigned long milliseconds = static_cast<unsigned long>(ms_total % 1000);
-
-    // Log header: [sec.msec] [LEVEL] [thread_name]
-    printf("%s[%5lu.%03lu] [%s] [%-15s]%s ",
-            log_level_colors[level],
-            seconds,
-            milliseconds,
-            log_level_strings[level],
-            ThisThread::get_name(),
-            log_level_colors_reset);
+    log_print_header(level, ms_total, ThisThread::get_name());
 
     // User message (printf-style).
     va_list args;
@@ -80,3 +97,219 @@ void log_print(LogLevel_t level, const char* format, ...) {
 
     serial_unlock();
 }
+
+#ifdef LOG_DEFERRED
+
+std::atomic<bool> g_log_deferred(false);
+
+// Ring of fixed-size records: many producers (any thread), one consumer
+// (the drain thread). Producers claim a position with a CAS on the head and
+// never wait; see log_record_t for the per-slot sequence protocol.
+static log_record_t log_ring[LOG_DEFERRED_RECORDS];
+static_assert(sizeof(log_ring) == LOG_DEFERRED_RING_BYTES, "update LOG_DEFERRED_RING_BYTES");
+static std::atomic<uint32_t> log_head(0);
+static uint32_t log_tail = 0;
+static std::atomic<uint32_t> log_dropped(0);
+static uint32_t log_dropped_reported = 0;
+
+MBED_ALIGN(8) static unsigned char log_drain_stack[LOG_DRAIN_STACK_SIZE];
+static_assert(sizeof(log_drain_stack) == LOG_DRAIN_STACK_SIZE, "drain stack size differs from the RAM budget");
+static Thread log_drain_thread(osPriorityLow, sizeof(log_drain_stack), log_drain_stack, "log_drain");
+
+static_assert((LOG_DEFERRED_RECORDS & (LOG_DEFERRED_RECORDS - 1)) == 0, "LOG_DEFERRED_RECORDS must be a power of two");
+
+log_record_t *log_deferred_reserve(LogLevel_t level, const char *format) {
+    uint32_t pos = log_head.load(std::memory_order_relaxed);
+    while (true) {
+        log_record_t *record = &log_ring[pos & (LOG_DEFERRED_RECORDS - 1)];
+        int32_t diff = (int32_t)(record->sequence.load(std::memory_order_acquire) - pos);
+        if (diff == 0) {
+            if (log_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                record->format = format;
+                record->thread_name = ThisThread::get_name();
+                record->time_us = us_ticker_read();
+                record->level = (uint8_t)level;
+                record->word_count = 0;
+                record->truncated = 0;
+                return record;
+            }
+        } else if (diff < 0) {
+            // Ring full: drop the new record rather than wait for the drain.
+            log_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            pos = log_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void log_deferred_commit(log_record_t *record) {
+    record->sequence.store(record->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+uint32_t log_deferred_dropped() {
+    return log_dropped.load(std::memory_order_relaxed);
+}
+
+// Read the next argument of type T from the record; false if it is missing.
+template <typename T>
+static bool log_take(const log_record_t *record, uint32_t *word, T *value) {
+    uint32_t words = (uint32_t)((sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+    if (*word + words > record->word_count) {
+        return false;
+    }
+    memcpy(value, &record->words[*word], sizeof(T));
+    *word += words;
+    return true;
+}
+
+// Print one conversion `spec` (e.g. "%-6s", "%5lu", "%.2f") with its argument.
+static void log_print_conversion(const log_record_t *record, uint32_t *word, const char *spec, const char *length, char conversion) {
+    bool ok = true;
+    bool is_long = length[0] == 'l' && length[1] != 'l';
+    bool is_long_long = (length[0] == 'l' && length[1] == 'l') || length[0] == 'j';
+
+    switch (conversion) {
+        case 'd':
+        case 'i':
+            if (is_long_long) {
+                long long v; if ((ok = log_take(record, word, &v))) printf(spec, v);
+            } else if (is_long) {
+                long v; if ((ok = log_take(record, word, &v))) printf(spec, v);
+            } else {
+                int v; if ((ok = log_take(record, word, &v))) printf(spec, v);
+            }
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            if (is_long_long) {
+                unsigned long long v; if ((ok = log_take(record, word, &v))) printf(spec, v);
+            } else if (is_long || length[0] == 'z') {
+                unsigned long v; if ((ok = log_take(record, word, &v))) printf(spec, v);
+            } else {
+                unsigned int v; if ((ok = log_take(record, word, &v))) printf(spec, v);
+            }
+            break;
+        case 'c': {
+            int v; if ((ok = log_take(record, word, &v))) printf(spec, v);
+            break;
+        }
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G': {
+            double v; if ((ok = log_take(record, word, &v))) printf(spec, v);
+            break;
+        }
+        case 's': {
+            const char *v; if ((ok = log_take(record, word, &v))) printf(spec, v != nullptr ? v : "(null)");
+            break;
+        }
+        case 'p': {
+            const void *v; if ((ok = log_take(record, word, &v))) printf(spec, v);
+            break;
+        }
+        default:
+            printf("%s", spec);
+            break;
+    }
+    if (!ok) {
+        printf("<?>");
+    }
+}
+
+// Format one record the way log_print() would have printed it.
+static void log_print_record(const log_record_t *record, uint64_t now_ms, uint32_t now_us) {
+    // Age from the us ticker, anchored on the kernel clock for the header.
+    // Records committed after the drain sampled the clocks count as age 0.
+    int32_t age_us = (int32_t)(now_us - record->time_us);
+    uint64_t age_ms = age_us > 0 ? (uint64_t)age_us / 1000u : 0;
+    log_print_header((LogLevel_t)record->level, now_ms > age_ms ? now_ms - age_ms : 0, record->thread_name);
+
+    uint32_t word = 0;
+    const char *p = record->format;
+    while (*p != '\0') {
+        const char *percent = strchr(p, '%');
+        if (percent == nullptr) {
+            fwrite(p, 1, strlen(p), stdout);
+            break;
+        }
+        fwrite(p, 1, (size_t)(percent - p), stdout);
+        p = percent + 1;
+        if (*p == '%') {
+            putchar('%');
+            p++;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion
+        char spec[16];
+        size_t n = 0;
+        spec[n++] = '%';
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != nullptr && n < sizeof(spec) - 4) {
+            spec[n++] = *p++;
+        }
+        const char *length = &spec[n];
+        while (*p != '\0' && strchr("hlzjtL", *p) != nullptr && n < sizeof(spec) - 2) {
+            spec[n++] = *p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        char conversion = *p++;
+        spec[n++] = conversion;
+        spec[n] = '\0';
+        log_print_conversion(record, &word, spec, length, conversion);
+    }
+    if (record->truncated) {
+        printf(" <truncated>");
+    }
+    printf("\r\n");
+}
+
+void log_drain() {
+    auto now = Kernel::Clock::now().time_since_epoch();
+    uint64_t now_ms = chrono::duration_cast<chrono::milliseconds>(now).count();
+    uint32_t now_us = us_ticker_read();
+
+    while (true) {
+        log_record_t *record = &log_ring[log_tail & (LOG_DEFERRED_RECORDS - 1)];
+        if (record->sequence.load(std::memory_order_acquire) != log_tail + 1) {
+            break;
+        }
+        serial_lock();
+        log_print_record(record, now_ms, now_us);
+        serial_unlock();
+        // Hand the slot back for the position one lap ahead.
+        record->sequence.store(log_tail + LOG_DEFERRED_RECORDS, std::memory_order_release);
+        log_tail++;
+    }
+
+    uint32_t dropped = log_dropped.load(std::memory_order_relaxed);
+    if (dropped != log_dropped_reported) {
+        log_print(LOG_LEVEL_WARN, "Log: %lu records dropped (ring full), %lu total",
+            (unsigned long)(dropped - log_dropped_reported), (unsigned long)dropped);
+        log_dropped_reported = dropped;
+    }
+}
+
+static void log_drain_task() {
+    while (true) {
+        log_drain();
+        ThisThread::sleep_for(LOG_DRAIN_PERIOD);
+    }
+}
+
+void log_deferred_start() {
+    for (uint32_t i = 0; i < LOG_DEFERRED_RECORDS; i++) {
+        log_ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    log_drain_thread.start(log_drain_task);
+    g_log_deferred.store(true, std::memory_order_release);
+}
+
+#endif // LOG_DEFERRED
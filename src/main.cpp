@@ -15,10 +15,54 @@
 #include "tasks/fft_task.hpp"
 #include "tasks/analysis_task.hpp"
 #include "tasks/ble_task.hpp"
+#include "pipeline.hpp"
+#include "mem_placement.hpp"
+#include "ram_budget.hpp"
+#include "profiler.hpp"
+#include "latency.hpp"
+#include "trace.hpp"
 
 
+static EventFlags program_fatal_error_flag_storage;
 EventFlags *program_fatal_error_flag = nullptr;
 
+// Task threads and their stacks are static: the RAM they use is fixed at link
+// time and shows up in the map file instead of the heap.
+#ifdef PIPELINE_SINGLE_THREAD
+MBED_ALIGN(8) static unsigned char pipeline_stack[PIPELINE_STACK_SIZE];
+static Thread pipeline_thread(osPriorityHigh, sizeof(pipeline_stack), pipeline_stack, "pipeline");
+static_assert(sizeof(pipeline_stack) == PIPELINE_STACK_SIZE, "stack sizes differ from the RAM budget");
+#elif defined(PIPELINE_COROUTINES)
+MBED_ALIGN(8) static unsigned char pipeline_stack[PIPELINE_STACK_SIZE];
+MBED_ALIGN(8) static unsigned char ble_stack[BLE_TASK_STACK_SIZE];
+static Thread pipeline_thread(osPriorityHigh, sizeof(pipeline_stack), pipeline_stack, "pipeline");
+static Thread ble_thread(osPriorityNormal, sizeof(ble_stack), ble_stack, "ble_task");
+static_assert(sizeof(pipeline_stack) == PIPELINE_STACK_SIZE && sizeof(ble_stack) == BLE_TASK_STACK_SIZE,
+    "stack sizes differ from the RAM budget");
+#else
+// Task priorities reflect timing sensitivity:
+// - IMU sampling must be most deterministic (Realtime).
+// - FFT and analysis should run promptly on fresh sensor data (High).
+// - LED/BLE are user-facing and can be lower priority (Normal).
+// - Test task is non-critical (Low).
+MBED_ALIGN(8) static unsigned char imu_stack[IMU_TASK_STACK_SIZE];
+MBED_ALIGN(8) static unsigned char fft_stack[FFT_TASK_STACK_SIZE];
+MBED_ALIGN(8) static unsigned char analysis_stack[ANALYSIS_TASK_STACK_SIZE];
+MBED_ALIGN(8) static unsigned char led_stack[LED_TASK_STACK_SIZE];
+MBED_ALIGN(8) static unsigned char ble_stack[BLE_TASK_STACK_SIZE];
+MBED_ALIGN(8) static unsigned char test_stack[TEST_TASK_STACK_SIZE];
+static Thread imu_thread(osPriorityRealtime, sizeof(imu_stack), imu_stack, "imu_task");
+static Thread fft_thread(osPriorityHigh, sizeof(fft_stack), fft_stack, "fft_task");
+static Thread analysis_thread(osPriorityHigh, sizeof(analysis_stack), analysis_stack, "analysis_task");
+static Thread led_thread(osPriorityNormal, sizeof(led_stack), led_stack, "led_task");
+static Thread ble_thread(osPriorityNormal, sizeof(ble_stack), ble_stack, "ble_task");
+static Thread test_thread(osPriorityLow, sizeof(test_stack), test_stack, "test_task");
+static_assert(sizeof(imu_stack) == IMU_TASK_STACK_SIZE && sizeof(fft_stack) == FFT_TASK_STACK_SIZE
+    && sizeof(analysis_stack) == ANALYSIS_TASK_STACK_SIZE && sizeof(led_stack) == LED_TASK_STACK_SIZE
+    && sizeof(ble_stack) == BLE_TASK_STACK_SIZE && sizeof(test_stack) == TEST_TASK_STACK_SIZE,
+    "stack sizes differ from the RAM budget");
+#endif
+
 /**
  * @brief Last-resort handler for unrecoverable failures.
  *
@@ -46,6 +90,11 @@ void trigger_fatal_error() {
 
 int main() {
 
+    // RAM-resident code must be in place before anything calls into it.
+    mem_placement_init();
+    profile_init();
+    latency_init();
+
     // Bring up minimal I/O first so we can signal failures early.
     if (!led_init()) {
         fatal_error_handler();
@@ -83,22 +132,33 @@ int main() {
     }
     LOG_INFO("IMU initialization [OK]");
 
-    // Allocated after basic init; tasks use this to request a global shutdown.
-    program_fatal_error_flag = new EventFlags();
+    // Published after basic init; tasks use this to request a global shutdown.
+    program_fatal_error_flag = &program_fatal_error_flag_storage;
+
+    if (!ble_subscribe_status()) {
+        LOG_FATAL("Motion status callback registration [FAIL]");
+        fatal_error_handler();
+    }
+
+    ram_budget_report();
+    trace_init();
+
+    // From here on, LOG_DEBUG/INFO/WARN go through the ring (LOG_DEFERRED).
+    log_deferred_start();
 
     LOG_INFO("Starting tasks...");
-    // Task priorities reflect timing sensitivity:
-    // - IMU sampling must be most deterministic (Realtime).
-    // - FFT and analysis should run promptly on fresh sensor data (High).
-    // - LED/BLE are user-facing and can be lower priority (Normal).
-    // - Test task is non-critical (Low).
-    Thread imu_thread(osPriorityRealtime, OS_STACK_SIZE, nullptr, "imu_task");
-    Thread fft_thread(osPriorityHigh, OS_STACK_SIZE, nullptr, "fft_task");
-    Thread analysis_thread(osPriorityHigh, OS_STACK_SIZE, nullptr, "analysis_task");
-    Thread led_thread(osPriorityNormal, OS_STACK_SIZE, nullptr, "led_task");
-    Thread ble_thread(osPriorityNormal, OS_STACK_SIZE, nullptr, "ble_task");
-    Thread test_thread(osPriorityLow, OS_STACK_SIZE, nullptr, "test_task");
+#ifdef PIPELINE_SINGLE_THREAD
+    // All stages run as run-to-completion handlers on one thread.
+    pipeline_thread.start(pipeline_task);
+
+    Thread* threads[] = { &pipeline_thread };
+#elif defined(PIPELINE_COROUTINES)
+    // Pipeline stages are coroutines on one thread; BLE keeps its own queue.
+    pipeline_thread.start(pipeline_coro_task);
+    ble_thread.start(ble_task);
 
+    Thread* threads[] = { &pipeline_thread, &ble_thread };
+#else
     imu_thread.start(imu_task);
     fft_thread.start(fft_task);
     analysis_thread.start(analysis_task);
@@ -106,6 +166,9 @@ int main() {
     ble_thread.start(ble_task);
     test_thread.start(test_task);
 
+    Thread* threads[] = { &imu_thread, &fft_thread, &analysis_thread, &led_thread, &ble_thread, &test_thread };
+#endif
+
     LOG_INFO("Tasks startup complete");
 
     // Main thread becomes the "supervisor": wait for any fatal error request,
@@ -113,7 +176,6 @@ int main() {
     if (program_fatal_error_flag->wait_all(1, osWaitForever) == 1) {
         LOG_FATAL("Program fatal error, terminating all tasks");
 
-        Thread* threads[] = { &imu_thread, &fft_thread, &analysis_thread, &led_thread, &ble_thread, &test_thread };
         for (Thread* t : threads) {
             if (t->get_state() != Thread::Deleted && t->get_state() != Thread::Inactive) {
                 t->terminate();
@@ -0,0 +1,24 @@
+/**
+ * @file mem_placement.cpp
+ * @brief Start-up copy of the RAM-resident code image (build option MEM_PLACEMENT).
+ */
+
+#ifdef MEM_PLACEMENT
+
+#include "mem_placement.hpp"
+#include "mbed.h"
+#include <string.h>
+
+// Defined by scripts/mem_placement.ld.
+extern uint8_t __ramfunc_start__[];
+extern uint8_t __ramfunc_end__[];
+extern uint8_t __ramfunc_load__[];
+
+void mem_placement_init() {
+    memcpy(__ramfunc_start__, __ramfunc_load__, (size_t)(__ramfunc_end__ - __ramfunc_start__));
+    // Make the new instructions visible before the first call into them.
+    __DSB();
+    __ISB();
+}
+
+#endif // MEM_PLACEMENT
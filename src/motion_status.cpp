@@ -0,0 +1,128 @@
+/**
+ * @file motion_status.cpp
+ * @brief Implementation of the atomic motion status word.
+ *
+ * There is a single writer (analysis task). The word is stored in a 32-bit
+ * atomic, which is a plain aligned load/store on Cortex-M4, so readers never
+ * observe a partially updated set of flags.
+ *
+ * Traces live in a small ring indexed by generation. Each slot is guarded by
+ * a tag derived from its generation, used like a sequence lock: the writer
+ * invalidates it before updating the timestamps, and readers re-check it after
+ * copying them.
+ */
+
+#include "motion_status.hpp"
+#include <atomic>
+#include "mbed.h"
+#include "hal/us_ticker_api.h"
+
+static_assert((MOTION_STATUS_TRACE_DEPTH & (MOTION_STATUS_TRACE_DEPTH - 1)) == 0, "MOTION_STATUS_TRACE_DEPTH must be a power of two");
+
+// Slot tag of a traced generation. Generations are 24-bit, so an all-zero
+// (or invalidated) slot never matches.
+#define MOTION_STATUS_TRACE_TAG(generation) ((generation) | 0x80000000u)
+
+typedef struct motion_status_trace_slot_t {
+    std::atomic<uint32_t> tag;
+    std::atomic<uint32_t> sample_time_us;
+    std::atomic<uint32_t> decision_time_us;
+} motion_status_trace_slot_t;
+
+static std::atomic<uint32_t> motion_status_word(0);
+static motion_status_trace_slot_t motion_status_traces[MOTION_STATUS_TRACE_DEPTH];
+static_assert(sizeof(motion_status_traces) == MOTION_STATUS_TRACE_BYTES, "update MOTION_STATUS_TRACE_BYTES");
+static EventFlags motion_status_flags;
+
+static Callback<void()> motion_status_callbacks[MOTION_STATUS_MAX_CALLBACKS];
+static int motion_status_callback_count = 0;
+
+// Split a raw status word into flags and generation.
+static motion_status_t motion_status_decode(uint32_t word) {
+    motion_status_t status;
+    status.flags = (uint8_t)(word & MOTION_STATUS_FLAGS_MASK);
+    status.generation = word >> MOTION_STATUS_GENERATION_SHIFT;
+    return status;
+}
+
+// Store the trace of `generation` before the status word makes it visible.
+static void motion_status_store_trace(uint32_t generation, bool traced, uint32_t sample_time_us) {
+    motion_status_trace_slot_t *slot = &motion_status_traces[generation & (MOTION_STATUS_TRACE_DEPTH - 1)];
+    slot->tag.store(0, std::memory_order_relaxed);
+    if (!traced) {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->sample_time_us.store(sample_time_us, std::memory_order_relaxed);
+    slot->decision_time_us.store(us_ticker_read(), std::memory_order_relaxed);
+    slot->tag.store(MOTION_STATUS_TRACE_TAG(generation), std::memory_order_release);
+}
+
+static bool motion_status_publish_internal(uint8_t flags, bool traced, uint32_t sample_time_us) {
+    uint32_t old_word = motion_status_word.load(std::memory_order_relaxed);
+    if ((old_word & MOTION_STATUS_FLAGS_MASK) == flags) {
+        return false;
+    }
+
+    // Generation lives in the upper bits, so adding one step wraps naturally.
+    uint32_t generation = (old_word >> MOTION_STATUS_GENERATION_SHIFT) + 1;
+    uint32_t new_word = (generation << MOTION_STATUS_GENERATION_SHIFT) | flags;
+    motion_status_store_trace(new_word >> MOTION_STATUS_GENERATION_SHIFT, traced, sample_time_us);
+    motion_status_word.store(new_word, std::memory_order_release);
+
+    // Wake every waiter; each one clears only its own bit. BLE is notified
+    // through its callback instead.
+    motion_status_flags.set(MOTION_STATUS_WAITER_LED);
+
+    for (int i = 0; i < motion_status_callback_count; i++) {
+        motion_status_callbacks[i]();
+    }
+    return true;
+}
+
+bool motion_status_publish(uint8_t flags) {
+    return motion_status_publish_internal(flags, false, 0);
+}
+
+bool motion_status_publish_traced(uint8_t flags, uint32_t sample_time_us) {
+    return motion_status_publish_internal(flags, true, sample_time_us);
+}
+
+motion_status_t motion_status_get() {
+    return motion_status_decode(motion_status_word.load(std::memory_order_acquire));
+}
+
+bool motion_status_get_trace(uint32_t generation, motion_status_trace_t *trace) {
+    const motion_status_trace_slot_t *slot = &motion_status_traces[generation & (MOTION_STATUS_TRACE_DEPTH - 1)];
+    if (slot->tag.load(std::memory_order_acquire) != MOTION_STATUS_TRACE_TAG(generation)) {
+        return false;
+    }
+    trace->sample_time_us = slot->sample_time_us.load(std::memory_order_relaxed);
+    trace->decision_time_us = slot->decision_time_us.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // The slot was reused while copying if the tag changed.
+    return slot->tag.load(std::memory_order_relaxed) == MOTION_STATUS_TRACE_TAG(generation);
+}
+
+bool motion_status_wait(uint32_t waiter, uint32_t last_generation, Kernel::Clock::duration timeout, motion_status_t *status) {
+    *status = motion_status_get();
+    if (status->generation != last_generation) {
+        // A change happened before we started waiting; drop the stale wakeup.
+        motion_status_flags.clear(waiter);
+        return true;
+    }
+
+    motion_status_flags.wait_any_for(waiter, timeout);
+
+    *status = motion_status_get();
+    return status->generation != last_generation;
+}
+
+bool motion_status_on_change(Callback<void()> cb) {
+    // Not synchronized with publishers: only called before the tasks start.
+    if (motion_status_callback_count >= MOTION_STATUS_MAX_CALLBACKS) {
+        return false;
+    }
+    motion_status_callbacks[motion_status_callback_count++] = cb;
+    return true;
+}
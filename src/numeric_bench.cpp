@@ -0,0 +1,91 @@
+/**
+ * @file numeric_bench.cpp
+ * @brief Start-up benchmark of double-promoting vs float-only hot-path math
+ *        (build option NUMERIC_BENCH).
+ *
+ * The "double" variants reproduce the expressions the numeric policy replaced,
+ * written with explicit casts so they still pass -Werror=double-promotion:
+ * - per sample: `raw * GYRO_SENSITIVITY / 360.0f * 2.0f * M_PI` on 3 gyro axes
+ * - per frame: `x / (y + 1e-6)` for the tremor, dyskinesia and freeze ratios
+ *   on each of the 3 gyro axes
+ * Inputs are read from a volatile table and results written to a volatile sink
+ * so neither variant is folded away. Cycle counts come from DWT->CYCCNT (profile_counter_now()).
+ */
+
+#ifdef NUMERIC_BENCH
+
+#define LOG_MODULE LOG_MODULE_TEST
+
+#include "numeric.hpp"
+#include "mbed.h"
+#include <inttypes.h>
+#include "logger.hpp"
+#include "profiler.hpp"
+#include "bsp/imu.hpp"
+#include "tasks/analysis_task.hpp"
+
+#define NUMERIC_BENCH_ROUNDS 256
+#define NUMERIC_BENCH_FRAME_RATIOS 9   // 3 detectors x 3 gyro axes
+#define NUMERIC_BENCH_SAMPLE_AXES 3
+
+static volatile int16_t bench_raw[NUMERIC_BENCH_SAMPLE_AXES];
+static volatile float32_t bench_power[2 * NUMERIC_BENCH_FRAME_RATIOS];
+static volatile float32_t bench_sink;
+
+static void bench_sample_double() {
+    for (int axis = 0; axis < NUMERIC_BENCH_SAMPLE_AXES; axis++) {
+        bench_sink = (float32_t)((double)bench_raw[axis] * (double)GYRO_SENSITIVITY / 360.0 * 2.0 * M_PI);
+    }
+}
+
+static void bench_sample_float() {
+    for (int axis = 0; axis < NUMERIC_BENCH_SAMPLE_AXES; axis++) {
+        bench_sink = (float32_t)bench_raw[axis] * IMU_GYRO_SCALE;
+    }
+}
+
+static void bench_frame_double() {
+    for (int i = 0; i < NUMERIC_BENCH_FRAME_RATIOS; i++) {
+        bench_sink = (float32_t)((double)bench_power[2 * i] / ((double)bench_power[2 * i + 1] + 1e-6));
+    }
+}
+
+static void bench_frame_float() {
+    for (int i = 0; i < NUMERIC_BENCH_FRAME_RATIOS; i++) {
+        bench_sink = numeric_ratio(bench_power[2 * i], bench_power[2 * i + 1]);
+    }
+}
+
+// Average cycles of one call over NUMERIC_BENCH_ROUNDS calls.
+static uint32_t bench_measure(void (*fn)()) {
+    fn(); // warm up caches / flash accelerator
+    uint32_t start = profile_counter_now();
+    for (int i = 0; i < NUMERIC_BENCH_ROUNDS; i++) {
+        fn();
+    }
+    return (profile_counter_now() - start) / NUMERIC_BENCH_ROUNDS;
+}
+
+static void bench_report(const char *name, uint32_t double_cycles, uint32_t float_cycles, uint32_t rate_hz) {
+    uint32_t recovered = double_cycles > float_cycles ? double_cycles - float_cycles : 0;
+    LOG_INFO("Numeric bench %-6s: double %5" PRIu32 " cyc, float %5" PRIu32 " cyc, recovered %5" PRIu32
+             " cyc (%" PRIu32 " cyc/s at %" PRIu32 " Hz)",
+        name, double_cycles, float_cycles, recovered, recovered * rate_hz, rate_hz);
+}
+
+void numeric_bench_run() {
+    profile_counter_enable();
+
+    for (int axis = 0; axis < NUMERIC_BENCH_SAMPLE_AXES; axis++) {
+        bench_raw[axis] = (int16_t)(1000 * (axis + 1));
+    }
+    for (int i = 0; i < 2 * NUMERIC_BENCH_FRAME_RATIOS; i++) {
+        bench_power[i] = 0.25f * (float32_t)(i + 1);
+    }
+
+    uint32_t frame_rate_hz = (uint32_t)(1s / ANALYSIS_PERIOD);
+    bench_report("sample", bench_measure(bench_sample_double), bench_measure(bench_sample_float), IMU_SAMPLE_RATE_HZ);
+    bench_report("frame", bench_measure(bench_frame_double), bench_measure(bench_frame_float), frame_rate_hz);
+}
+
+#endif // NUMERIC_BENCH
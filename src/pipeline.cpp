@@ -0,0 +1,186 @@
+/**
+ * @file pipeline.cpp
+ * @brief Single-thread cooperative pipeline built on one EventQueue.
+ *
+ * Only compiled in when PIPELINE_SINGLE_THREAD is defined. The stage functions
+ * are the same ones the threaded tasks use; only the scheduling differs.
+ */
+
+#ifdef PIPELINE_SINGLE_THREAD
+
+#define LOG_MODULE LOG_MODULE_PIPELINE
+
+#include "pipeline.hpp"
+#include "mbed.h"
+#include <inttypes.h>
+#include "logger.hpp"
+#include "main.hpp"
+#include "motion_status.hpp"
+#include "tasks/imu_task.hpp"
+#include "tasks/fft_task.hpp"
+#include "tasks/analysis_task.hpp"
+#include "tasks/led_task.hpp"
+#include "tasks/ble_task.hpp"
+#include "tasks/test_task.hpp"
+#include "task_monitor.hpp"
+
+#define PIPELINE_WATCHDOG_PERIOD 1000ms
+
+MBED_ALIGN(8) static unsigned char pipeline_queue_buffer[PIPELINE_QUEUE_BYTES];
+static EventQueue pipeline_queue(sizeof(pipeline_queue_buffer), pipeline_queue_buffer);
+
+static imu_data_t pipeline_sample;
+static uint32_t pipeline_decimation = 0;
+
+// Counters since the last report.
+static uint32_t pipeline_events = 0;
+static uint32_t pipeline_samples = 0;
+static uint32_t pipeline_frames = 0;
+static uint32_t pipeline_total_samples = 0;
+static uint32_t pipeline_watchdog_samples = 0;
+static Kernel::Clock::time_point pipeline_report_time;
+
+static task_monitor_t pipeline_sample_monitor;
+static task_monitor_t pipeline_frame_monitor;
+
+static void pipeline_process_sample(uint32_t edge_us);
+
+/**
+ * @brief Per-sample handler: runs every stage in a fixed order.
+ * @param edge_us Data-ready time captured by the interrupt that queued it.
+ */
+static void pipeline_on_sample(uint32_t edge_us) {
+    pipeline_events++;
+    task_monitor_begin(&pipeline_sample_monitor);
+    pipeline_process_sample(edge_us);
+    task_monitor_end(&pipeline_sample_monitor);
+}
+
+static void pipeline_process_sample(uint32_t edge_us) {
+    // Stage 1: IMU drain.
+    if (!imu_sample_read(&pipeline_sample, edge_us)) {
+        return;
+    }
+    pipeline_samples++;
+    pipeline_total_samples++;
+
+    // Stage 2: spectral. Push every sample, transform at the analysis cadence.
+    fft_push_sample(&pipeline_sample);
+    if (!fft_window_ready()) {
+        return;
+    }
+    if (++pipeline_decimation < PIPELINE_ANALYSIS_DECIMATION) {
+        return;
+    }
+    pipeline_decimation = 0;
+    task_monitor_begin(&pipeline_frame_monitor);
+    if (!fft_compute(pipeline_sample.timestamp_us)) {
+        task_monitor_end(&pipeline_frame_monitor);
+        return;
+    }
+    pipeline_frames++;
+
+    // Stage 3: analysis (publishes the status word; BLE notify is queued by
+    // its change callback and runs right after this handler).
+    uint32_t generation = motion_status_get().generation;
+    analysis_step();
+    task_monitor_end(&pipeline_frame_monitor);
+
+    // Stage 4: output. Render immediately when the status changed.
+    if (motion_status_get().generation != generation) {
+        led_step();
+    }
+}
+
+static void pipeline_on_led_tick() {
+    pipeline_events++;
+    led_step();
+}
+
+static void pipeline_on_report() {
+    pipeline_events++;
+    test_report();
+}
+
+static void pipeline_on_watchdog() {
+    pipeline_events++;
+    if (pipeline_total_samples == pipeline_watchdog_samples) {
+        LOG_FATAL("IMU data wait timeout");
+        trigger_fatal_error();
+    }
+    pipeline_watchdog_samples = pipeline_total_samples;
+}
+
+void pipeline_report() {
+    auto now = Kernel::Clock::now();
+    uint32_t elapsed_ms = (uint32_t)(now - pipeline_report_time).count();
+    pipeline_report_time = now;
+    if (elapsed_ms == 0) {
+        return;
+    }
+
+    uint32_t events_per_s = pipeline_events * 1000 / elapsed_ms;
+    uint32_t samples_per_s = pipeline_samples * 1000 / elapsed_ms;
+    uint32_t frames_per_s = pipeline_frames * 1000 / elapsed_ms;
+
+    // Estimated, not measured (the RTX switch hook belongs to the trace
+    // buffer, see trace.hpp): each queue event here, and in the threaded
+    // build each wakeup, is taken as a switch in and a switch out. Threaded
+    // wakeups: imu_task per sample, fft_task polling every 1 ms while samples
+    // arrive (at least once per sample), analysis and LED on their periods.
+    uint32_t threaded_wakeups = samples_per_s * 2
+        + 1000 / (uint32_t)chrono::milliseconds(ANALYSIS_PERIOD).count()
+        + 1000 / (uint32_t)chrono::milliseconds(LED_TICK_PERIOD).count();
+    uint32_t threaded_switches = threaded_wakeups * 2;
+    uint32_t pipeline_switches = events_per_s * 2;
+
+    LOG_INFO("Pipeline: %" PRIu32 " samples/s, %" PRIu32 " frames/s, %" PRIu32 " events/s",
+        samples_per_s, frames_per_s, events_per_s);
+    LOG_INFO("Pipeline: context switches (estimate, not measured) ~%" PRIu32 "/s, threaded ~%" PRIu32 "/s, avoided ~%" PRIu32 "/s",
+        pipeline_switches, threaded_switches,
+        threaded_switches > pipeline_switches ? threaded_switches - pipeline_switches : 0);
+
+    pipeline_events = 0;
+    pipeline_samples = 0;
+    pipeline_frames = 0;
+}
+
+void pipeline_task() {
+    LOG_INFO("Pipeline Task Started");
+
+    uint32_t threaded_stack_bytes = PIPELINE_THREADED_STACK_BYTES;
+    LOG_INFO("Single-thread pipeline: %" PRIu32 " B of task stacks instead of %" PRIu32 " B (saved %" PRIu32 " B)",
+        (uint32_t)PIPELINE_STACK_SIZE, threaded_stack_bytes, threaded_stack_bytes - (uint32_t)PIPELINE_STACK_SIZE);
+
+    if (!fft_init()) {
+        trigger_fatal_error();
+        return;
+    }
+    analysis_init();
+    test_init();
+    ble_init(&pipeline_queue);
+
+    pipeline_report_time = Kernel::Clock::now();
+
+    // The sample handler must finish within one sample period; the frame part
+    // (FFT + analysis) runs every PIPELINE_ANALYSIS_DECIMATION samples.
+    task_monitor_register(&pipeline_sample_monitor, "sample", TASK_MONITOR_PERIOD_US(IMU_SAMPLE_RATE_HZ), TASK_MONITOR_PERIOD_US(IMU_SAMPLE_RATE_HZ));
+    task_monitor_register(&pipeline_frame_monitor, "frame", TASK_MONITOR_PERIOD_US(IMU_SAMPLE_RATE_HZ) * PIPELINE_ANALYSIS_DECIMATION, FFT_TASK_BUDGET_US + ANALYSIS_TASK_BUDGET_US);
+
+    pipeline_queue.call_every(LED_TICK_PERIOD, pipeline_on_led_tick);
+    pipeline_queue.call_every(SAMPLE_TIME_MS * 1ms, pipeline_on_report);
+    pipeline_queue.call_every(PIPELINE_WATCHDOG_PERIOD, pipeline_on_watchdog);
+
+    // One event per data-ready edge, carrying its own timestamp so queued
+    // events do not all read the newest edge. EventQueue::call() is ISR-safe
+    // and returns 0 when the queue is full.
+    imu_data_ready_attach([]() {
+        if (pipeline_queue.call(pipeline_on_sample, imu_data_ready_time_us()) == 0) {
+            imu_edge_unqueued();
+        }
+    });
+
+    pipeline_queue.dispatch_forever();
+}
+
+#endif // PIPELINE_SINGLE_THREAD
@@ -0,0 +1,91 @@
+/**
+ * @file profiler.cpp
+ * @brief Duration histograms, stage names and the per-stage cycle profiler
+ *        (build option STAGE_PROFILE).
+ */
+
+#define LOG_MODULE LOG_MODULE_TEST
+
+#include "profiler.hpp"
+#include <inttypes.h>
+#include <string.h>
+#include "logger.hpp"
+
+static_assert(PROFILE_BUCKETS == 16 && PROFILE_BUCKET_SHIFT == 6, "update the histogram labels in profile_stats_log()");
+
+static uint32_t profile_bucket(uint32_t elapsed) {
+    uint32_t scaled = elapsed >> PROFILE_BUCKET_SHIFT;
+    if (scaled == 0) {
+        return 0;
+    }
+    uint32_t bucket = 32u - (uint32_t)__builtin_clz(scaled);
+    return bucket < PROFILE_BUCKETS ? bucket : PROFILE_BUCKETS - 1;
+}
+
+void profile_stats_reset(profile_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->min = UINT32_MAX;
+}
+
+void profile_stats_add(profile_stats_t *stats, uint32_t elapsed) {
+    stats->count++;
+    stats->sum += elapsed;
+    if (elapsed < stats->min) stats->min = elapsed;
+    if (elapsed > stats->max) stats->max = elapsed;
+    stats->buckets[profile_bucket(elapsed)]++;
+}
+
+void profile_stats_log(const char *prefix, const char *name, const profile_stats_t *stats, const char *unit) {
+    if (stats->count == 0) {
+        return;
+    }
+    const uint32_t *b = stats->buckets;
+    LOG_INFO("%s %-17s n %5" PRIu32 " | min %7" PRIu32 " mean %7" PRIu32 " max %7" PRIu32 " %s",
+        prefix, name, stats->count, stats->min, (uint32_t)(stats->sum / stats->count), stats->max, unit);
+    // Bucket i >= 1 starts at 2^(PROFILE_BUCKET_SHIFT + i - 1).
+    LOG_INFO("  hist <64 %" PRIu32 " | %" PRIu32 " %" PRIu32 " %" PRIu32 " %" PRIu32 " %" PRIu32 " %" PRIu32 " %" PRIu32
+        " %" PRIu32 " %" PRIu32 " %" PRIu32 " %" PRIu32 " %" PRIu32 " %" PRIu32 " %" PRIu32 " | >=2^20 %" PRIu32,
+        b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7], b[8], b[9], b[10], b[11], b[12], b[13], b[14], b[15]);
+}
+
+static const char *profile_stage_names[PROFILE_STAGE_COUNT] = {
+    "imu_read_raw",
+    "imu_read_fifo",
+    "mirror_push",
+    "window_load",
+    "rfft",
+    "psd",
+    "detect_tremor",
+    "detect_dyskinesia",
+    "detect_fog",
+};
+
+const char *profile_stage_name(profile_stage_t stage) {
+    return stage < PROFILE_STAGE_COUNT ? profile_stage_names[stage] : "?";
+}
+
+#ifdef STAGE_PROFILE
+
+static profile_stats_t profile_stats[PROFILE_STAGE_COUNT];
+static_assert(sizeof(profile_stats) == PROFILE_STATS_BYTES, "update PROFILE_STATS_BYTES");
+
+void profile_init() {
+    profile_counter_enable();
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        profile_stats_reset(&profile_stats[i]);
+    }
+}
+
+void profile_record(profile_stage_t stage, uint32_t elapsed) {
+    profile_stats_add(&profile_stats[stage], elapsed);
+}
+
+void profile_report() {
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        profile_stats_t stats = profile_stats[i];
+        profile_stats_reset(&profile_stats[i]);
+        profile_stats_log("Profile", profile_stage_name((profile_stage_t)i), &stats, PROFILE_UNIT);
+    }
+}
+
+#endif // STAGE_PROFILE
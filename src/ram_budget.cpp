@@ -0,0 +1,100 @@
+/**
+ * @file ram_budget.cpp
+ * @brief RAM budget table of the statically allocated system objects.
+ */
+
+#include "ram_budget.hpp"
+#include "mbed.h"
+#include "mbed_stats.h"
+#include <inttypes.h>
+#include "logger.hpp"
+#include "buffer.hpp"
+#include "pipeline.hpp"
+#include "trace.hpp"
+#include "profiler.hpp"
+#include "latency.hpp"
+#include "motion_status.hpp"
+#include "tasks/imu_task.hpp"
+#include "tasks/fft_task.hpp"
+#include "tasks/analysis_task.hpp"
+#include "tasks/led_task.hpp"
+#include "tasks/ble_task.hpp"
+#include "tasks/test_task.hpp"
+#ifdef PIPELINE_COROUTINES
+#include "coro.hpp"
+#endif
+
+typedef struct ram_budget_entry_t {
+    const char *category;
+    const char *name;
+    uint32_t bytes;
+} ram_budget_entry_t;
+
+// One entry per object of the active build mode. Every size is a constant that
+// a static_assert next to the object's definition checks against sizeof().
+static constexpr ram_budget_entry_t ram_budget_table[] = {
+#if defined(PIPELINE_SINGLE_THREAD)
+    { "stack", "pipeline", PIPELINE_STACK_SIZE },
+#elif defined(PIPELINE_COROUTINES)
+    { "stack", "pipeline", PIPELINE_STACK_SIZE },
+    { "stack", "ble_task", BLE_TASK_STACK_SIZE },
+#else
+    { "stack", "imu_task", IMU_TASK_STACK_SIZE },
+    { "stack", "fft_task", FFT_TASK_STACK_SIZE },
+    { "stack", "analysis_task", ANALYSIS_TASK_STACK_SIZE },
+    { "stack", "led_task", LED_TASK_STACK_SIZE },
+    { "stack", "ble_task", BLE_TASK_STACK_SIZE },
+    { "stack", "test_task", TEST_TASK_STACK_SIZE },
+#endif
+#ifdef LOG_DEFERRED
+    { "stack", "log_drain", LOG_DRAIN_STACK_SIZE },
+#endif
+    { "dsp", "sensor_data_buffer", FFT_SENSOR_BUFFER_BYTES },
+    { "dsp", "fft_input", FFT_WORK_BUFFER_BYTES },
+    { "dsp", "fft_output", FFT_WORK_BUFFER_BYTES },
+    { "dsp", "fft_handlers", FFT_HANDLERS_BYTES },
+    { "queue", "imu_mail_box", IMU_MAILBOX_BYTES },
+#ifdef PIPELINE_SINGLE_THREAD
+    { "queue", "pipeline_queue", PIPELINE_QUEUE_BYTES },
+#else
+    { "queue", "ble_own_queue", BLE_QUEUE_BYTES },
+#endif
+#ifdef PIPELINE_COROUTINES
+    { "queue", "coro_frame_pool", CORO_FRAME_POOL_SIZE },
+#endif
+#ifdef LOG_DEFERRED
+    { "queue", "log_ring", LOG_DEFERRED_RING_BYTES },
+#endif
+#ifdef TRACE_BUFFER
+    { "queue", "trace_ring", sizeof(g_trace_ring) },
+#endif
+    { "result", "fft_results", FFT_RESULTS_BYTES },
+    { "result", "motion_status_traces", MOTION_STATUS_TRACE_BYTES },
+    { "diag", "thread_stats", TEST_THREAD_STATS_BYTES },
+    { "diag", "latency_stats", LATENCY_STATS_BYTES },
+#ifdef STAGE_PROFILE
+    { "diag", "profile_stats", PROFILE_STATS_BYTES },
+#endif
+#ifdef BUFFER_BENCH
+    { "bench", "buffer_bench", BUFFER_BENCH_BYTES },
+#endif
+};
+
+static constexpr uint32_t ram_budget_total() {
+    uint32_t total = 0;
+    for (const ram_budget_entry_t &entry : ram_budget_table) {
+        total += entry.bytes;
+    }
+    return total;
+}
+
+static_assert(ram_budget_total() <= RAM_BUDGET_LIMIT_BYTES,
+    "Static RAM budget exceeded: shrink a stack, buffer or queue, or revisit RAM_BUDGET_LIMIT_BYTES");
+
+void ram_budget_report() {
+    LOG_INFO("RAM budget:");
+    for (const ram_budget_entry_t &entry : ram_budget_table) {
+        LOG_INFO("  %-7s %-20s %6" PRIu32 " B", entry.category, entry.name, entry.bytes);
+    }
+    LOG_INFO("  total %6" PRIu32 " of %6" PRIu32 " B", ram_budget_total(), (uint32_t)RAM_BUDGET_LIMIT_BYTES);
+}
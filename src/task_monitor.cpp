@@ -0,0 +1,99 @@
+/**
+ * @file task_monitor.cpp
+ * @brief Implementation of the per-task period / budget monitor.
+ */
+
+#define LOG_MODULE LOG_MODULE_TEST
+
+#include "task_monitor.hpp"
+#include "mbed.h"
+#include "hal/us_ticker_api.h"
+#include <inttypes.h>
+#include "logger.hpp"
+
+static task_monitor_t *task_monitor_list = nullptr;
+static Mutex task_monitor_list_mutex;
+
+// Reset the per-window statistics.
+static void task_monitor_reset_window(task_monitor_t *monitor) {
+    monitor->activations = 0;
+    monitor->interval_min_us = UINT32_MAX;
+    monitor->interval_max_us = 0;
+    monitor->exec_sum_us = 0;
+    monitor->exec_max_us = 0;
+}
+
+void task_monitor_register(task_monitor_t *monitor, const char *name, uint32_t period_us, uint32_t budget_us) {
+    monitor->name = name;
+    monitor->period_us = period_us;
+    monitor->budget_us = budget_us;
+    monitor->start_us = 0;
+    monitor->last_start_us = 0;
+    monitor->started = false;
+    monitor->worst_interval_us = 0;
+    monitor->worst_exec_us = 0;
+    monitor->deadline_misses = 0;
+    monitor->budget_overruns = 0;
+    task_monitor_reset_window(monitor);
+
+    task_monitor_list_mutex.lock();
+    monitor->next = task_monitor_list;
+    task_monitor_list = monitor;
+    task_monitor_list_mutex.unlock();
+}
+
+void task_monitor_begin(task_monitor_t *monitor) {
+    uint32_t now = us_ticker_read();
+    monitor->start_us = now;
+
+    if (monitor->started) {
+        // Unsigned subtraction handles ticker wrap-around.
+        uint32_t interval = now - monitor->last_start_us;
+        if (interval < monitor->interval_min_us) monitor->interval_min_us = interval;
+        if (interval > monitor->interval_max_us) monitor->interval_max_us = interval;
+        if (interval > monitor->worst_interval_us) monitor->worst_interval_us = interval;
+
+        uint32_t late_limit = monitor->period_us + monitor->period_us * TASK_MONITOR_TOLERANCE_PCT / 100;
+        if (monitor->period_us != 0 && interval > late_limit) {
+            monitor->deadline_misses++;
+        }
+    }
+    monitor->last_start_us = now;
+    monitor->started = true;
+}
+
+void task_monitor_end(task_monitor_t *monitor) {
+    uint32_t exec = us_ticker_read() - monitor->start_us;
+
+    monitor->activations++;
+    monitor->exec_sum_us += exec;
+    if (exec > monitor->exec_max_us) monitor->exec_max_us = exec;
+    if (exec > monitor->worst_exec_us) monitor->worst_exec_us = exec;
+
+    if (exec > monitor->budget_us) {
+        monitor->budget_overruns++;
+    }
+    if (monitor->period_us != 0 && exec > monitor->period_us) {
+        monitor->deadline_misses++;
+    }
+}
+
+void task_monitor_resync(task_monitor_t *monitor) {
+    monitor->started = false;
+}
+
+void task_monitor_report() {
+    task_monitor_list_mutex.lock();
+    for (task_monitor_t *m = task_monitor_list; m != nullptr; m = m->next) {
+        uint32_t exec_avg = m->activations ? m->exec_sum_us / m->activations : 0;
+        uint32_t interval_min = m->interval_min_us == UINT32_MAX ? 0 : m->interval_min_us;
+        LOG_INFO("%-10s period %6" PRIu32 " us: n %5" PRIu32 " | interval %6" PRIu32 "..%6" PRIu32 " us (worst %6" PRIu32 ")"
+                  " | exec avg %5" PRIu32 " max %5" PRIu32 " us (worst %5" PRIu32 ", budget %5" PRIu32 ")"
+                  " | misses %" PRIu32 " overruns %" PRIu32,
+            m->name, m->period_us, m->activations, interval_min, m->interval_max_us, m->worst_interval_us,
+            exec_avg, m->exec_max_us, m->worst_exec_us, m->budget_us,
+            m->deadline_misses, m->budget_overruns);
+        task_monitor_reset_window(m);
+    }
+    task_monitor_list_mutex.unlock();
+}
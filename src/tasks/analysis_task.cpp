@@ -12,16 +12,30 @@
  * Implementation notes:
  * - PSD is indexed by FFT bin k. Bin frequency is: f_k = k * Fs / N
  *   where Fs is sampling_rate and N is fft_size.
- * - We add a small epsilon (1e-6) to denominators to avoid divide-by-zero.
+ * - Ratios use `numeric_ratio()`, which adds NUMERIC_EPSILON (1e-6f) to the
+ *   denominator to avoid divide-by-zero without promoting to double.
  * - The boolean filters smooth results to prevent flickering.
+ * - Filtered outputs are published together as one atomic status word (see
+ *   `motion_status.hpp`) so consumers never see a mix of old and new flags.
  */
 
+#define LOG_MODULE LOG_MODULE_ANALYSIS
+
 #include "tasks/analysis_task.hpp"
 #include "mbed.h"
 #include "logger.hpp"
 #include "main.hpp"
 #include "tasks/fft_task.hpp"
 #include "bool_filter.hpp"
+#include "motion_status.hpp"
+#include "task_monitor.hpp"
+#include "adaptive_odr.hpp"
+#include "activity_gate.hpp"
+#include "hal/us_ticker_api.h"
+#include "numeric.hpp"
+#include "mem_placement.hpp"
+#include "profiler.hpp"
+#include "latency.hpp"
 
 
 bool_filter_t tremor_filter;
@@ -40,7 +54,7 @@ bool_filter_t fog_filter;
  * @param peak_power Output: peak power within the band.
  * @param peak_freq Output: frequency (Hz) of that peak.
  */
-void find_peak_power(float32_t* psd, uint32_t fft_size, float32_t sampling_rate, float32_t min_freq, float32_t max_freq, float32_t* peak_power, float32_t* peak_freq) {
+MEM_FAST_CODE void find_peak_power(float32_t* psd, uint32_t fft_size, float32_t sampling_rate, float32_t min_freq, float32_t max_freq, float32_t* peak_power, float32_t* peak_freq) {
     float32_t peak_power_temp = 0.0f;
     float32_t peak_freq_temp = 0.0f;
     uint32_t min_idx = (uint32_t)(min_freq * fft_size / sampling_rate);
@@ -65,7 +79,7 @@ void find_peak_power(float32_t* psd, uint32_t fft_size, float32_t sampling_rate,
  * @param max_freq Upper band edge (Hz).
  * @return Sum of PSD bins between min_freq and max_freq (inclusive).
  */
-float32_t find_total_band_power(float32_t* psd, uint32_t fft_size, float32_t sampling_rate, float32_t min_freq, float32_t max_freq) {
+MEM_FAST_CODE float32_t find_total_band_power(float32_t* psd, uint32_t fft_size, float32_t sampling_rate, float32_t min_freq, float32_t max_freq) {
     uint32_t min_idx = (uint32_t)(min_freq * fft_size / sampling_rate);
     uint32_t max_idx = (uint32_t)(max_freq * fft_size / sampling_rate);
     float32_t total_band_power = 0.0f;
@@ -92,6 +106,7 @@ float32_t find_total_band_power(float32_t* psd, uint32_t fft_size, float32_t sam
  * @return true if tremor is detected on this axis.
  */
 bool detectTremor(float32_t* psd, uint32_t fft_size, float32_t sampling_rate) {
+    PROFILE_SCOPE(PROFILE_STAGE_DETECT_TREMOR);
     float32_t band_peak_power = 0.0f;
     float32_t band_peak_freq = 0.0f;
 
@@ -99,14 +114,14 @@ bool detectTremor(float32_t* psd, uint32_t fft_size, float32_t sampling_rate) {
     float32_t tremor_total_power = find_total_band_power(psd, fft_size, sampling_rate, TREMOR_MIN_FREQ, TREMOR_MAX_FREQ);
     float32_t total_band_power = find_total_band_power(psd, fft_size, sampling_rate, BAND_MIN_FREQ, BAND_MAX_FREQ);
 
-    float32_t relative_power = tremor_total_power / (total_band_power + 1e-6);
+    float32_t relative_power = numeric_ratio(tremor_total_power, total_band_power);
 
     bool freq_check = (band_peak_freq >= TREMOR_MIN_FREQ && band_peak_freq <= TREMOR_MAX_FREQ);
     bool relative_power_check = (relative_power > RELATIVE_POWER_THRESHOLD);
     bool absolute_power_check = (band_peak_power > MIN_PEAK_POWER_THRESHOLD);
 
     LOG_DEBUG("freq_check: %.1f <%s> , relative_power_check: %.1f <%s>, absolute_power_check: %.1f <%s>", 
-        band_peak_freq, freq_check ? "true " : "false", relative_power, relative_power_check ? "true " : "false", band_peak_power, absolute_power_check ? "true " : "false");
+        (double)band_peak_freq, freq_check ? "true " : "false", (double)relative_power, relative_power_check ? "true " : "false", (double)band_peak_power, absolute_power_check ? "true " : "false");
 
     return (freq_check && relative_power_check && absolute_power_check);
 }
@@ -123,6 +138,7 @@ bool detectTremor(float32_t* psd, uint32_t fft_size, float32_t sampling_rate) {
  * @return true if dyskinesia is detected on this axis.
  */
 bool detectDyskinesia(float32_t* psd, uint32_t fft_size, float32_t sampling_rate) {
+    PROFILE_SCOPE(PROFILE_STAGE_DETECT_DYSKINESIA);
     float32_t band_peak_power = 0.0f;
     float32_t band_peak_freq = 0.0f;
 
@@ -130,14 +146,14 @@ bool detectDyskinesia(float32_t* psd, uint32_t fft_size, float32_t sampling_rate
     float32_t dyskinesia_total_power = find_total_band_power(psd, fft_size, sampling_rate, DYSKINESIA_MIN_FREQ, DYSKINESIA_MAX_FREQ);
     float32_t total_band_power = find_total_band_power(psd, fft_size, sampling_rate, BAND_MIN_FREQ, BAND_MAX_FREQ);
 
-    float32_t relative_power = dyskinesia_total_power / (total_band_power + 1e-6);
+    float32_t relative_power = numeric_ratio(dyskinesia_total_power, total_band_power);
 
     bool freq_check = (band_peak_freq >= DYSKINESIA_MIN_FREQ && band_peak_freq <= DYSKINESIA_MAX_FREQ);
     bool relative_power_check = (relative_power > RELATIVE_POWER_THRESHOLD);
     bool absolute_power_check = (band_peak_power > MIN_PEAK_POWER_THRESHOLD);
 
     LOG_DEBUG("freq_check: %.1f <%s> , relative_power_check: %.1f <%s>, absolute_power_check: %.1f <%s>", 
-        band_peak_freq, freq_check ? "true " : "false", relative_power, relative_power_check ? "true " : "false", band_peak_power, absolute_power_check ? "true " : "false");
+        (double)band_peak_freq, freq_check ? "true " : "false", (double)relative_power, relative_power_check ? "true " : "false", (double)band_peak_power, absolute_power_check ? "true " : "false");
 
     return (freq_check && relative_power_check && absolute_power_check);
 }
@@ -166,7 +182,8 @@ static bool is_walking = false;
  * @return true if FOG is detected on this axis.
  */
 bool detectFOG(float32_t* psd, uint32_t fft_size, float32_t sampling_rate) {
-    
+    PROFILE_SCOPE(PROFILE_STAGE_DETECT_FOG);
+
     // 1) Compute freeze-band power (3–8 Hz).
     float32_t freeze_power = find_total_band_power(psd, fft_size, sampling_rate, 
                                                    FOG_FREEZE_MIN_FREQ, FOG_FREEZE_MAX_FREQ);
@@ -193,7 +210,7 @@ bool detectFOG(float32_t* psd, uint32_t fft_size, float32_t sampling_rate) {
     }
     
     // 4) Compute Freeze Index (FI). Epsilon avoids division by zero.
-    float32_t freeze_index = freeze_power / (locomotion_power + 1e-6);
+    float32_t freeze_index = numeric_ratio(freeze_power, locomotion_power);
 
     // 5) FOG decision logic.
     bool fi_check = (freeze_index > FOG_FI_THRESHOLD);
@@ -201,9 +218,9 @@ bool detectFOG(float32_t* psd, uint32_t fft_size, float32_t sampling_rate) {
     bool freeze_power_check = (freeze_power > 0.05f); // ensure meaningful freeze-band energy
     
     LOG_DEBUG("FI: %.2f <%s>, walking: <%s>, freeze_pwr: %.3f <%s>", 
-        freeze_index, fi_check ? "true " : "false", 
+        (double)freeze_index, fi_check ? "true " : "false", 
         is_walking ? "true " : "false",
-        freeze_power, freeze_power_check ? "true " : "false");
+        (double)freeze_power, freeze_power_check ? "true " : "false");
     
     // FOG detection requires:
     // 1) Freeze Index above threshold
@@ -212,75 +229,152 @@ bool detectFOG(float32_t* psd, uint32_t fft_size, float32_t sampling_rate) {
     return (fi_check && walking_check && freeze_power_check);
 }
 
+// Raw (unfiltered) decisions from the previous frame, used for edge logging.
+static bool last_tremor_status = false;
+static bool last_dyskinesia_status = false;
+static bool last_fog_status = false;
+
+void analysis_init() {
+    bool_filter_init(&tremor_filter, 2);
+    bool_filter_init(&dyskinesia_filter, 2);
+    bool_filter_init(&fog_filter, 2);
+
+    last_tremor_status = false;
+    last_dyskinesia_status = false;
+    last_fog_status = false;
+}
+
 /**
- * @brief RTOS task loop: read latest FFT result, run detectors, update filters.
+ * @brief Run detectors on the latest FFT result and update filters.
  *
  * We run detectors on each gyro axis and then OR the three decisions to form an
  * overall status. The boolean filters provide temporal smoothing.
  */
+bool analysis_step() {
+#ifdef IMU_ACTIVITY_GATING
+    // Gated off, or windows still refilling after a wakeup: nothing to detect.
+    if (!activity_gate_is_open() || !fft_window_ready()) {
+        motion_status_publish(0);
+        return true;
+    }
+#endif
+#ifdef IMU_ADAPTIVE_ODR
+    // Resting, or windows still refilling after a wakeup: nothing to detect.
+    if (adaptive_odr_get_state() != ADAPTIVE_ODR_ACTIVE || !fft_window_ready()) {
+        motion_status_publish(0);
+        return true;
+    }
+#endif
+
+    fft_result_t *result = fft_find_and_lock_latest_result();
+    if (result == nullptr) {
+        return false;
+    }
+
+    bool tremor_result[3] = {false, false, false};
+    bool dyskinesia_result[3] = {false, false, false};
+    bool fog_result[3] = {false, false, false};
+
+    for (int i = 0; i < 3; i++) {
+        tremor_result[i] = detectTremor(result->gyro_psd[i], result->fft_size, IMU_SAMPLE_RATE_HZ);
+    }
+    for (int i = 0; i < 3; i++) {
+        dyskinesia_result[i] = detectDyskinesia(result->gyro_psd[i], result->fft_size, IMU_SAMPLE_RATE_HZ);
+    }
+    for (int i = 0; i < 3; i++) {
+        fog_result[i] = detectFOG(result->gyro_psd[i], result->fft_size, IMU_SAMPLE_RATE_HZ);
+    }
+    
+    bool is_tremor = tremor_result[0] || tremor_result[1] || tremor_result[2];
+    bool is_dyskinesia = dyskinesia_result[0] || dyskinesia_result[1] || dyskinesia_result[2];
+    bool is_fog = fog_result[0] || fog_result[1] || fog_result[2];
+
+    LOG_DEBUG("tremor: %s %s %s, dyskinesia: %s %s %s, fog: %s %s %s, overall: %s %s %s", 
+        tremor_result[0] ? "true" : "false", tremor_result[1] ? "true" : "false", tremor_result[2] ? "true" : "false", 
+        dyskinesia_result[0] ? "true" : "false", dyskinesia_result[1] ? "true" : "false", dyskinesia_result[2] ? "true" : "false",
+        fog_result[0] ? "true" : "false", fog_result[1] ? "true" : "false", fog_result[2] ? "true" : "false",
+        is_tremor ? "true" : "false", is_dyskinesia ? "true" : "false", is_fog ? "true" : "false");
+
+    uint32_t sample_time_us = result->sample_time_us;
+    uint32_t spectrum_time_us = result->spectrum_time_us;
+#ifdef IMU_ADAPTIVE_ODR
+    float32_t motion_power = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float32_t power = find_total_band_power(result->gyro_psd[i], result->fft_size, IMU_SAMPLE_RATE_HZ, 0.5f, BAND_MAX_FREQ);
+        if (power > motion_power) {
+            motion_power = power;
+        }
+    }
+#endif
+    result->mutex.unlock();
+
+#ifdef IMU_ADAPTIVE_ODR
+    adaptive_odr_frame(motion_power, sample_time_us);
+#endif
+
+    bool_filter_update(&tremor_filter, is_tremor);
+    bool_filter_update(&dyskinesia_filter, is_dyskinesia);
+    bool_filter_update(&fog_filter, is_fog);
+
+    uint8_t status_flags = 0;
+    if (bool_filter_get_state(&tremor_filter)) status_flags |= MOTION_STATUS_TREMOR;
+    if (bool_filter_get_state(&dyskinesia_filter)) status_flags |= MOTION_STATUS_DYSKINESIA;
+    if (bool_filter_get_state(&fog_filter)) status_flags |= MOTION_STATUS_FOG;
+    motion_status_publish_traced(status_flags, sample_time_us);
+
+    // A change carries sample_time_us to the outputs; these two cover every frame.
+    uint32_t decision_time_us = us_ticker_read();
+    latency_record(LATENCY_SPECTRUM_TO_DECISION, spectrum_time_us, decision_time_us);
+    latency_record(LATENCY_SAMPLE_TO_DECISION, sample_time_us, decision_time_us);
+
+    if (last_tremor_status != is_tremor && is_tremor == true) {
+        LOG_INFO("Tremor detected!");
+    }
+    if (last_dyskinesia_status != is_dyskinesia && is_dyskinesia == true) {
+        LOG_INFO("Dyskinesia detected!");
+    }
+    if (last_fog_status != is_fog && is_fog == true) {
+        LOG_INFO("FOG detected!");
+    }
+
+    last_tremor_status = is_tremor;
+    last_dyskinesia_status = is_dyskinesia;
+    last_fog_status = is_fog;
+    return true;
+}
+
+/**
+ * @brief RTOS task loop: run one analysis step every ANALYSIS_PERIOD.
+ */
 void analysis_task() {
     LOG_INFO("Analysis Task Started");
 
-    bool_filter_init(&tremor_filter, 2);
-    bool_filter_init(&dyskinesia_filter, 2);
-    bool_filter_init(&fog_filter, 2);
+    analysis_init();
 
-    bool last_tremor_status = false;
-    bool last_dyskinesia_status = false;
-    bool last_fog_status = false;
+    // The loop sleeps ANALYSIS_PERIOD after each step, so the expected
+    // activation interval is the period plus the step itself.
+    static task_monitor_t analysis_monitor;
+    task_monitor_register(&analysis_monitor, "analysis",
+        (uint32_t)chrono::microseconds(ANALYSIS_PERIOD).count() + ANALYSIS_TASK_BUDGET_US, ANALYSIS_TASK_BUDGET_US);
 
     while (true) {
-        fft_result_t *result = fft_find_and_lock_latest_result();
-        if (result != nullptr) {
-            bool tremor_result[3] = {false, false, false};
-            bool dyskinesia_result[3] = {false, false, false};
-            bool fog_result[3] = {false, false, false};
-
-            for (int i = 0; i < 3; i++) {
-                tremor_result[i] = detectTremor(result->gyro_psd[i], FFT_BUFFER_SIZE, IMU_SAMPLE_RATE_HZ);
-            }
-            for (int i = 0; i < 3; i++) {
-                dyskinesia_result[i] = detectDyskinesia(result->gyro_psd[i], FFT_BUFFER_SIZE, IMU_SAMPLE_RATE_HZ);
-            }
-            for (int i = 0; i < 3; i++) {
-                fog_result[i] = detectFOG(result->gyro_psd[i], FFT_BUFFER_SIZE, IMU_SAMPLE_RATE_HZ);
-            }
-            
-            bool is_tremor = tremor_result[0] || tremor_result[1] || tremor_result[2];
-            bool is_dyskinesia = dyskinesia_result[0] || dyskinesia_result[1] || dyskinesia_result[2];
-            bool is_fog = fog_result[0] || fog_result[1] || fog_result[2];
-
-            LOG_DEBUG("tremor: %s %s %s, dyskinesia: %s %s %s, fog: %s %s %s, overall: %s %s %s", 
-                tremor_result[0] ? "true" : "false", tremor_result[1] ? "true" : "false", tremor_result[2] ? "true" : "false", 
-                dyskinesia_result[0] ? "true" : "false", dyskinesia_result[1] ? "true" : "false", dyskinesia_result[2] ? "true" : "false",
-                fog_result[0] ? "true" : "false", fog_result[1] ? "true" : "false", fog_result[2] ? "true" : "false",
-                is_tremor ? "true" : "false", is_dyskinesia ? "true" : "false", is_fog ? "true" : "false");
-
-            result->mutex.unlock();
-
-            bool_filter_update(&tremor_filter, is_tremor);
-            bool_filter_update(&dyskinesia_filter, is_dyskinesia);
-            bool_filter_update(&fog_filter, is_fog);
-
-            if (last_tremor_status != is_tremor && is_tremor == true) {
-                LOG_INFO("Tremor detected!");
-            }
-            if (last_dyskinesia_status != is_dyskinesia && is_dyskinesia == true) {
-                LOG_INFO("Dyskinesia detected!");
-            }
-            if (last_fog_status != is_fog && is_fog == true) {
-                LOG_INFO("FOG detected!");
-            }
-
-            last_tremor_status = is_tremor;
-            last_dyskinesia_status = is_dyskinesia;
-            last_fog_status = is_fog;
-        } else {
+#ifdef IMU_ACTIVITY_GATING
+        // Sensor asleep: report NONE and block until it wakes up.
+        if (!activity_gate_is_open()) {
+            motion_status_publish(0);
+            activity_gate_wait_open(ACTIVITY_GATE_WAITER_ANALYSIS);
+            task_monitor_resync(&analysis_monitor);
+        }
+#endif
+        task_monitor_begin(&analysis_monitor);
+        bool processed = analysis_step();
+        task_monitor_end(&analysis_monitor);
+        if (!processed) {
             LOG_WARN("No FFT result available");
             ThisThread::sleep_for(1ms);
             continue;
         }
-        ThisThread::sleep_for(100ms);
+        ThisThread::sleep_for(ANALYSIS_PERIOD);
     }
 }
 
@@ -290,7 +384,7 @@ void analysis_task() {
  * @return true if tremor is detected after filtering.
  */
 bool get_tremor_status() {
-    return bool_filter_get_state(&tremor_filter);
+    return (motion_status_get().flags & MOTION_STATUS_TREMOR) != 0;
 }
 
 /**
@@ -298,7 +392,7 @@ bool get_tremor_status() {
  * @return true if dyskinesia is detected after filtering.
  */
 bool get_dyskinesia_status() {
-    return bool_filter_get_state(&dyskinesia_filter);
+    return (motion_status_get().flags & MOTION_STATUS_DYSKINESIA) != 0;
 }
 
 /**
@@ -306,5 +400,5 @@ bool get_dyskinesia_status() {
  * @return true if FOG is detected after filtering.
  */
 bool get_fog_status() {
-    return bool_filter_get_state(&fog_filter);
+    return (motion_status_get().flags & MOTION_STATUS_FOG) != 0;
 }
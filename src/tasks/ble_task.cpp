@@ -5,8 +5,13 @@
  * The device advertises a custom service containing one read-only, notify-only
  * characteristic. The characteristic value is a null-terminated ASCII string:
  * "TREMOR", "DYSKINESIA", "FOG", or "NONE".
+ *
+ * Notifications are event driven: the motion status publisher posts a
+ * notification to the BLE event queue whenever the status word changes.
  */
 
+#define LOG_MODULE LOG_MODULE_BLE
+
 #include "tasks/ble_task.hpp"
 #include "mbed.h"
 #include "ble/BLE.h"
@@ -19,7 +24,8 @@
 #include <string.h>
 #include "logger.hpp"
 #include "main.hpp"
-#include "tasks/analysis_task.hpp"
+#include "motion_status.hpp"
+#include "latency.hpp"
 
 
 using namespace ble;
@@ -27,7 +33,14 @@ using namespace events;
 using namespace std::chrono;
 
 BLE &ble_interface = BLE::Instance();
-EventQueue event_queue;
+// Queue that runs BLE processing (own thread, or the shared pipeline queue).
+#ifndef PIPELINE_SINGLE_THREAD
+MBED_ALIGN(8) static unsigned char ble_own_queue_buffer[BLE_QUEUE_BYTES];
+static EventQueue ble_own_queue(sizeof(ble_own_queue_buffer), ble_own_queue_buffer);
+EventQueue *event_queue = &ble_own_queue;
+#else
+EventQueue *event_queue = nullptr;
+#endif
 
 const UUID TREMOR_SERVICE_UUID("A0E1B2C3-D4E5-F6A7-B8C9-D0E1F2A3B4C5");
 const UUID TREMOR_TYPE_CHAR_UUID("A1E2B3C4-D5E6-F7A8-B9C0-D1E2F3A4B5C6");
@@ -50,25 +63,30 @@ TREMORTypeCharacteristic(
 GattCharacteristic *charTable[] = { &TREMORTypeCharacteristic };
 GattService TREMOR_Service(TREMOR_SERVICE_UUID, charTable, 1);
 
-Ticker notification_ticker;
 bool device_connected = false;
 
+// Last generation notified (or skipped while disconnected), so the re-send on
+// connect is not counted as latency.
+static uint32_t ble_notified_generation = 0;
+
 /**
  * @brief Send a status notification if a central is connected.
  *
- * The value is derived from the analysis task's filtered status getters.
+ * The value is derived from one snapshot of the motion status word.
  */
 void send_TREMOR_notification() {
     if (!device_connected) {
         LOG_DEBUG("No device connected, skipping notification");
+        ble_notified_generation = motion_status_get().generation;
         return;
     }
     
-    if (get_fog_status()) {
+    motion_status_t status = motion_status_get();
+    if (status.flags & MOTION_STATUS_FOG) {
         strcpy((char*)TREMORValue, FOG_STRING);
-    } else if (get_dyskinesia_status()) {
+    } else if (status.flags & MOTION_STATUS_DYSKINESIA) {
         strcpy((char*)TREMORValue, DYSKINESIA_STRING);
-    } else if (get_tremor_status()) {
+    } else if (status.flags & MOTION_STATUS_TREMOR) {
         strcpy((char*)TREMORValue, TREMOR_STRING);
     } else {
         strcpy((char*)TREMORValue, NONE_STRING);
@@ -79,6 +97,10 @@ void send_TREMOR_notification() {
         TREMORValue,
         strlen((char*)TREMORValue) + 1
     );
+    if (status.generation != ble_notified_generation) {
+        latency_record_output(LATENCY_DECISION_TO_BLE, LATENCY_SAMPLE_TO_BLE, status.generation);
+        ble_notified_generation = status.generation;
+    }
     
     LOG_DEBUG("Sent notification: %s", (char*)TREMORValue);
 }
@@ -90,19 +112,16 @@ public:
         if (event.getStatus() == BLE_ERROR_NONE) {
             LOG_INFO("BLE device connected");
             device_connected = true;
-            strcpy((char*)TREMORValue, TREMOR_STRING);
-            
-            // Periodically push notifications via the event queue context.
-            notification_ticker.attach([]() {
-                event_queue.call(send_TREMOR_notification);
-            }, 1s);
+
+            // Push the current state right away; later changes are pushed by
+            // the status change callback.
+            event_queue->call(send_TREMOR_notification);
         }
     }
     
     virtual void onDisconnectionComplete(const
         ble::DisconnectionCompleteEvent &event) {
         device_connected = false;
-        notification_ticker.detach();
         ble_interface.gap().startAdvertising(ble::LEGACY_ADVERTISING_HANDLE);
         LOG_INFO("BLE device disconnected, restarting advertising");
     }
@@ -151,16 +170,32 @@ void on_ble_init_complete(BLE::InitializationCompleteCallbackContext *params) {
  * work directly in interrupt contexts.
  */
 void schedule_ble_events(BLE::OnEventsToProcessCallbackContext *context) {
-    event_queue.call(callback(&ble_interface, &BLE::processEvents));
+    event_queue->call(callback(&ble_interface, &BLE::processEvents));
+}
+
+bool ble_subscribe_status() {
+    // Status changes are forwarded into the event queue context. With
+    // PIPELINE_SINGLE_THREAD the queue is set by ble_init() on the pipeline
+    // thread before it dispatches, i.e. before the first publish.
+    return motion_status_on_change([]() {
+        event_queue->call(send_TREMOR_notification);
+    });
 }
 
+void ble_init(EventQueue *queue) {
+    event_queue = queue;
+    ble_interface.onEventsToProcess(schedule_ble_events);
+    ble_interface.init(on_ble_init_complete);
+}
+
+#ifndef PIPELINE_SINGLE_THREAD
 void ble_task() {
     LOG_INFO("BLE Task Started");
     // BLE runs inside the event queue forever.
-    ble_interface.onEventsToProcess(schedule_ble_events);
-    ble_interface.init(on_ble_init_complete);
-    event_queue.dispatch_forever();
+    ble_init(&ble_own_queue);
+    ble_own_queue.dispatch_forever();
 }
+#endif
 
 bool ble_is_connected() {
     return device_connected;
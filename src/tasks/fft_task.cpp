@@ -4,24 +4,38 @@
  *
  * Data flow (high level):
  * - `imu_task` publishes samples to `imu_mail_box`.
- * - This task maintains a sliding window of the latest FFT_BUFFER_SIZE samples
- *   per axis using mirror buffers.
+ * - This task maintains a sliding window of the latest FFT_BUFFER_SIZE raw
+ *   samples per axis in one multi-channel mirror buffer (int16, one channel
+ *   per raw word, scaled per window).
  * - For each new sample, it computes a real FFT and derives single-sided
  *   magnitude spectrum and PSD (power spectral density) for accel and gyro.
  * - Results are stored in a small ring of `fft_result_t` buffers protected by
  *   per-buffer mutexes.
  */
 
+#define LOG_MODULE LOG_MODULE_FFT
+
 #include "tasks/fft_task.hpp"
 #include "mbed.h"
+#include <inttypes.h>
 #include "arm_math.h"
 #include "logger.hpp"
 #include "buffer.hpp"
 #include "tasks/imu_task.hpp"
 #include "main.hpp"
+#include "task_monitor.hpp"
+#include "governor.hpp"
+#include "adaptive_odr.hpp"
+#include "activity_gate.hpp"
+#include "mem_placement.hpp"
+#include "hal/us_ticker_api.h"
+#include "profiler.hpp"
+#include "latency.hpp"
+#include "trace.hpp"
 
 
 arm_rfft_fast_instance_f32 fft_handler;
+arm_rfft_fast_instance_f32 fft_handler_small;
 /**
  * @brief PSD normalization scale factor.
  *
@@ -30,46 +44,230 @@ arm_rfft_fast_instance_f32 fft_handler;
  * based on window length and sampling rate.
  */
 float32_t scale_factor = 1.0f / (FFT_BUFFER_SIZE * IMU_SAMPLE_RATE_HZ);
+/**
+ * @brief PSD scale factor for the reduced FFT size.
+ *
+ * A tone's |X[k]|^2 grows with N^2, so the extra FFT_BUFFER_SIZE/FFT_SMALL_SIZE
+ * factor keeps peak and band powers on the same scale as the full-size PSD.
+ */
+float32_t scale_factor_small = (float32_t)FFT_BUFFER_SIZE / ((float32_t)FFT_SMALL_SIZE * FFT_SMALL_SIZE * IMU_SAMPLE_RATE_HZ);
 
-mirror_buffer_t *accel_sensor_data_buffer[3];
-mirror_buffer_t *gyro_sensor_data_buffer[3];
-float32_t fft_input[FFT_BUFFER_SIZE];
-float32_t fft_output[FFT_BUFFER_SIZE];
+// One channel per raw word (gyro x/y/z, then accel x/y/z), shared write index.
+MEM_FAST_BSS static mirror_buffer_multi<int16_t, IMU_RAW_WORDS, FFT_BUFFER_SIZE> sensor_data_buffer;
+MEM_FAST_BSS float32_t fft_input[FFT_BUFFER_SIZE];
+MEM_FAST_BSS float32_t fft_output[FFT_BUFFER_SIZE];
 fft_result_t fft_results[FFT_BUFFER_NUM];
+static_assert(sizeof(sensor_data_buffer) == FFT_SENSOR_BUFFER_BYTES, "update FFT_SENSOR_BUFFER_BYTES");
+static_assert(sizeof(fft_input) == FFT_WORK_BUFFER_BYTES && sizeof(fft_output) == FFT_WORK_BUFFER_BYTES, "update FFT_WORK_BUFFER_BYTES");
+static_assert(sizeof(fft_handler) + sizeof(fft_handler_small) == FFT_HANDLERS_BYTES, "update FFT_HANDLERS_BYTES");
+static_assert(sizeof(fft_results) == FFT_RESULTS_BYTES, "update FFT_RESULTS_BYTES");
+
+
+static uint32_t fft_window_fill = 0;
+static uint32_t fft_backlog_max = 0;
+static task_monitor_t fft_monitor;
+static uint32_t fft_resume_epoch = 0;
+
+// Sequence tracking for gap detection.
+static bool fft_have_seq = false;
+static uint32_t fft_next_seq = 0;
+static int16_t fft_last_raw[IMU_RAW_WORDS];
+static fft_gap_stats_t fft_gap_stats;
+
+
+bool fft_init() {
+    sensor_data_buffer.reset();
+
+    arm_rfft_fast_init_f32(&fft_handler, FFT_BUFFER_SIZE);
+    arm_rfft_fast_init_f32(&fft_handler_small, FFT_SMALL_SIZE);
+    fft_window_fill = 0;
+    return true;
+}
+
+// Changes whenever sampling resumes after a pause (adaptive ODR rest or
+// activity gating).
+static uint32_t fft_current_resume_epoch() {
+#if defined(IMU_ADAPTIVE_ODR)
+    return adaptive_odr_epoch();
+#elif defined(IMU_ACTIVITY_GATING)
+    return activity_gate_epoch();
+#else
+    return 0;
+#endif
+}
+
+// Append one raw sample (gyro x/y/z, accel x/y/z) to the windows.
+MEM_FAST_CODE static void fft_push_raw(const int16_t *raw) {
+    {
+        PROFILE_SCOPE(PROFILE_STAGE_MIRROR_PUSH);
+        sensor_data_buffer.push(raw);
+    }
+    if (fft_window_fill < FFT_BUFFER_SIZE) {
+        fft_window_fill++;
+    }
+}
+
+// Fill `gap` missing samples on a straight line between the last pushed
+// sample and `sample`.
+static void fft_fill_gap(const imu_data_t *sample, uint32_t gap) {
+    int16_t raw[IMU_RAW_WORDS];
+    for (uint32_t k = 1; k <= gap; k++) {
+        for (int i = 0; i < IMU_RAW_WORDS; i++) {
+            int32_t delta = (int32_t)sample->raw[i] - fft_last_raw[i];
+            raw[i] = (int16_t)(fft_last_raw[i] + delta * (int32_t)k / (int32_t)(gap + 1));
+        }
+        fft_push_raw(raw);
+    }
+}
 
+void fft_push_sample(const imu_data_t *sample) {
+    // First sample after a pause: restart the windows so no spectrum spans it.
+    uint32_t epoch = fft_current_resume_epoch();
+    if (epoch != fft_resume_epoch) {
+        fft_resume_epoch = epoch;
+        fft_window_fill = 0;
+        fft_have_seq = false;
+        task_monitor_resync(&fft_monitor);
+    }
+
+    if (fft_have_seq) {
+        int32_t gap = (int32_t)(sample->seq - fft_next_seq);
+        if (gap < 0) {
+            fft_gap_stats.stale++;
+            return;
+        }
+        if (gap > 0) {
+            fft_gap_stats.gaps++;
+            if (gap <= FFT_MAX_INTERP_GAP) {
+                fft_fill_gap(sample, (uint32_t)gap);
+                fft_gap_stats.interpolated += gap;
+            } else {
+                // Too long to bridge: start a fresh window.
+                fft_window_fill = 0;
+                fft_gap_stats.restarts++;
+            }
+        }
+    }
+
+    fft_push_raw(sample->raw);
+    memcpy(fft_last_raw, sample->raw, sizeof(fft_last_raw));
+    fft_next_seq = sample->seq + 1;
+    fft_have_seq = true;
+}
+
+bool fft_window_ready() {
+    return fft_window_fill >= FFT_START_FILL;
+}
+
+// int16 -> float over a whole block, four samples per iteration. The vendored
+// CMSIS-DSP tree has no SupportFunctions, so arm_q15_to_float is not linked.
+MEM_FAST_CODE static void fft_int16_to_float(const int16_t *src, float32_t *dst, uint32_t count) {
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        dst[i] = (float32_t)src[i];
+        dst[i + 1] = (float32_t)src[i + 1];
+        dst[i + 2] = (float32_t)src[i + 2];
+        dst[i + 3] = (float32_t)src[i + 3];
+    }
+    for (; i < count; i++) {
+        dst[i] = (float32_t)src[i];
+    }
+}
+
+// Convert the newest `fft_size` raw samples of a window to physical units
+// in fft_input: one int16 -> float pass and one scale for the whole block.
+MEM_FAST_CODE static void fft_load_window(const int16_t *window, uint32_t window_offset, uint32_t fft_size, float32_t unit_scale) {
+    PROFILE_SCOPE(PROFILE_STAGE_WINDOW_LOAD);
+    fft_int16_to_float(window + window_offset, fft_input, fft_size);
+    arm_scale_f32(fft_input, unit_scale, fft_input, fft_size);
+}
+
+// Spectrum of one axis: window -> rfft -> |X[k]| -> scaled |X[k]|^2.
+MEM_FAST_CODE static void fft_axis_spectrum(arm_rfft_fast_instance_f32 *handler, const int16_t *window, uint32_t window_offset,
+                                            uint32_t fft_size, float32_t unit_scale, float32_t psd_scale,
+                                            float32_t *magnitude, float32_t *psd) {
+    fft_load_window(window, window_offset, fft_size, unit_scale);
+    {
+        PROFILE_SCOPE(PROFILE_STAGE_RFFT);
+        arm_rfft_fast_f32(handler, fft_input, fft_output, 0);
+    }
+    PROFILE_SCOPE(PROFILE_STAGE_PSD);
+    arm_cmplx_mag_f32(fft_output, magnitude, fft_size / 2);
+    arm_mult_f32(magnitude, magnitude, psd, fft_size / 2);
+    arm_scale_f32(psd, psd_scale, psd, fft_size / 2);
+}
+
+MEM_FAST_CODE bool fft_compute(uint32_t sample_time_us) {
+    fft_result_t *result_buffer = fft_find_and_lock_oldest_result();
+    if (result_buffer == nullptr) {
+        LOG_WARN("Failed to find available FFT result buffer");
+        return false;
+    }
+
+    // The governor may shrink the transform to the newest FFT_SMALL_SIZE
+    // samples and skip the accel axes under overload. A window that is still
+    // filling (see FFT_START_FILL) also uses the small transform.
+    bool small_fft = governor_small_fft() || fft_window_fill < FFT_BUFFER_SIZE;
+    bool accel_enabled = governor_accel_enabled();
+    arm_rfft_fast_instance_f32 *handler = small_fft ? &fft_handler_small : &fft_handler;
+    uint32_t fft_size = small_fft ? FFT_SMALL_SIZE : FFT_BUFFER_SIZE;
+    uint32_t window_offset = FFT_BUFFER_SIZE - fft_size;
+    float32_t psd_scale = small_fft ? scale_factor_small : scale_factor;
+
+    // Processing steps per axis:
+    // 1) Convert the latest sliding-window samples into fft_input.
+    // 2) Real FFT: time-domain -> frequency-domain.
+    // 3) Magnitude spectrum |X[k]| for k=0..N/2-1 (single-sided).
+    // 4) Power: |X[k]|^2 (simple PSD estimate).
+    // 5) Scale/normalize to keep thresholds stable across configs.
+    if (accel_enabled) {
+        for (int i = 0; i < 3; i++) {
+            fft_axis_spectrum(handler, sensor_data_buffer.window(IMU_RAW_ACCEL + i), window_offset, fft_size, IMU_ACC_SCALE, psd_scale,
+                              result_buffer->accel_magnitude[i], result_buffer->accel_psd[i]);
+        }
+    }
+
+
+    for (int i = 0; i < 3; i++) {
+        fft_axis_spectrum(handler, sensor_data_buffer.window(IMU_RAW_GYRO + i), window_offset, fft_size, IMU_GYRO_SCALE, psd_scale,
+                          result_buffer->gyro_magnitude[i], result_buffer->gyro_psd[i]);
+    }
+
+    result_buffer->fft_size = fft_size;
+    result_buffer->accel_valid = accel_enabled;
+
+    result_buffer->sample_time_us = sample_time_us;
+    result_buffer->spectrum_time_us = us_ticker_read();
+    result_buffer->timestamp = Kernel::Clock::now();
+    latency_record(LATENCY_SAMPLE_TO_SPECTRUM, sample_time_us, result_buffer->spectrum_time_us);
+    result_buffer->mutex.unlock();
+    return true;
+}
 
 /**
  * @brief RTOS task entry: compute FFT/PSD continuously from IMU samples.
  *
  * Notes:
- * - We wait until we have a full window (FFT_BUFFER_SIZE samples). After that,
- *   each incoming sample updates the sliding window and triggers a new FFT.
+ * - We wait until FFT_START_FILL samples have arrived (a full window unless the
+ *   build pauses sampling). After that, each incoming sample updates the
+ *   sliding window and triggers a new FFT.
  * - CMSIS-DSP `arm_rfft_fast_f32` computes an efficient real-input FFT.
  * - We store only the single-sided spectrum (0..Nyquist), hence N/2 bins.
  */
 void fft_task() {
     LOG_INFO("FFT Task Started");
 
-    for (int i = 0; i < 3; i++) {
-        accel_sensor_data_buffer[i] = mirror_buffer_create(FFT_BUFFER_SIZE, sizeof(float32_t));
-        gyro_sensor_data_buffer[i] = mirror_buffer_create(FFT_BUFFER_SIZE, sizeof(float32_t));
-        if (!accel_sensor_data_buffer[i] || !gyro_sensor_data_buffer[i]) {
-            LOG_FATAL("Failed to create buffer");
-            trigger_fatal_error();
-            return;
-        }
+    if (!fft_init()) {
+        trigger_fatal_error();
+        return;
     }
 
-    arm_rfft_fast_init_f32(&fft_handler, FFT_BUFFER_SIZE);
-
-    LOG_INFO("Waiting for %d points of IMU data", FFT_BUFFER_SIZE);
-    for (int i = 0; i < FFT_BUFFER_SIZE; i++) {
+    LOG_INFO("Waiting for %d points of IMU data", FFT_START_FILL);
+    while (!fft_window_ready()) {
         imu_data_t *imu_data = imu_mail_box->try_get_for(Kernel::wait_for_u32_forever);
         if (imu_data != nullptr) {
-            for (int i = 0; i < 3; i++) {
-                mirror_buffer_push(accel_sensor_data_buffer[i], &imu_data->accel[i]);
-                mirror_buffer_push(gyro_sensor_data_buffer[i], &imu_data->gyro[i]);
-            }
+            trace_record(TRACE_MAIL_GET, imu_data->seq);
+            fft_push_sample(imu_data);
             imu_mail_box->free(imu_data);
         } else {
             LOG_WARN("Failed to receive IMU data");
@@ -77,58 +275,58 @@ void fft_task() {
         }
     }
 
+    task_monitor_register(&fft_monitor, "fft", TASK_MONITOR_PERIOD_US(IMU_SAMPLE_RATE_HZ), FFT_TASK_BUDGET_US);
+
+    uint32_t samples_since_fft = 0;
     while (true) {
+#ifdef IMU_ACTIVITY_GATING
+        // Sensor asleep: block once the queued samples are drained.
+        if (!activity_gate_is_open() && imu_mail_box->empty()) {
+            activity_gate_wait_open(ACTIVITY_GATE_WAITER_FFT);
+        }
+#endif
+        uint32_t backlog = 0;
         while (!imu_mail_box->empty()) {
             imu_data_t *imu_data = imu_mail_box->try_get();
             if (imu_data != nullptr) {
-                for (int i = 0; i < 3; i++) {
-                    mirror_buffer_push(accel_sensor_data_buffer[i], &imu_data->accel[i]);
-                    mirror_buffer_push(gyro_sensor_data_buffer[i], &imu_data->gyro[i]);
-                }
+                trace_record(TRACE_MAIL_GET, imu_data->seq);
+                backlog++;
+                task_monitor_begin(&fft_monitor);
+                fft_push_sample(imu_data);
+                uint32_t sample_time_us = imu_data->timestamp_us;
                 imu_mail_box->free(imu_data);
 
-                fft_result_t *result_buffer = fft_find_and_lock_oldest_result();
-                if (result_buffer == nullptr) {
-                    LOG_WARN("Failed to find available FFT result buffer");
-                    continue;
-                }
-
-                // Processing steps per axis:
-                // 1) Copy the latest sliding-window samples into fft_input.
-                // 2) Real FFT: time-domain -> frequency-domain.
-                // 3) Magnitude spectrum |X[k]| for k=0..N/2-1 (single-sided).
-                // 4) Power: |X[k]|^2 (simple PSD estimate).
-                // 5) Scale/normalize to keep thresholds stable across configs.
-                for (int i = 0; i < 3; i++) {
-                    memcpy(fft_input, (float32_t*)mirror_buffer_get_window(accel_sensor_data_buffer[i]), FFT_BUFFER_SIZE * sizeof(float32_t));
-                    arm_rfft_fast_f32(&fft_handler, fft_input, fft_output, 0);
-                    arm_cmplx_mag_f32(fft_output, result_buffer->accel_magnitude[i], FFT_BUFFER_SIZE / 2);
-                    arm_mult_f32(result_buffer->accel_magnitude[i], result_buffer->accel_magnitude[i], result_buffer->accel_psd[i], FFT_BUFFER_SIZE / 2);
-                    arm_scale_f32(result_buffer->accel_psd[i], scale_factor, result_buffer->accel_psd[i], FFT_BUFFER_SIZE / 2);
-                }
-
-
-                for (int i = 0; i < 3; i++) {
-                    memcpy(fft_input, (float32_t*)mirror_buffer_get_window(gyro_sensor_data_buffer[i]), FFT_BUFFER_SIZE * sizeof(float32_t));
-                    arm_rfft_fast_f32(&fft_handler, fft_input, fft_output, 0);
-                    arm_cmplx_mag_f32(fft_output, result_buffer->gyro_magnitude[i], FFT_BUFFER_SIZE / 2);
-                    arm_mult_f32(result_buffer->gyro_magnitude[i], result_buffer->gyro_magnitude[i], result_buffer->gyro_psd[i], FFT_BUFFER_SIZE / 2);
-                    arm_scale_f32(result_buffer->gyro_psd[i], scale_factor, result_buffer->gyro_psd[i], FFT_BUFFER_SIZE / 2);
+                // Hop size is chosen by the governor (1 = every sample). The
+                // window can be refilling after an adaptive-ODR wakeup.
+                if (++samples_since_fft >= governor_hop_size() && fft_window_ready()) {
+                    samples_since_fft = 0;
+                    fft_compute(sample_time_us);
                 }
-
-                result_buffer->timestamp = Kernel::Clock::now();
-                result_buffer->mutex.unlock();
-
+                task_monitor_end(&fft_monitor);
             } else {
                 LOG_WARN("Failed to get IMU data");
                 imu_mail_box->free(imu_data);
                 continue;
             }
         }
+        if (backlog > fft_backlog_max) {
+            fft_backlog_max = backlog;
+        }
         ThisThread::sleep_for(1ms);
     }
 }
 
+void fft_gaps_get_and_reset(fft_gap_stats_t *stats) {
+    *stats = fft_gap_stats;
+    fft_gap_stats = fft_gap_stats_t();
+}
+
+uint32_t fft_backlog_get_and_reset() {
+    uint32_t backlog = fft_backlog_max;
+    fft_backlog_max = 0;
+    return backlog;
+}
+
 /**
  * @brief Find the oldest (least recently updated) result buffer and lock it.
  *
@@ -152,6 +350,8 @@ fft_result_t *fft_find_and_lock_oldest_result() {
             } else {
                 fft_results[i].mutex.unlock();
             }
+        } else {
+            trace_record(TRACE_TRYLOCK_FAIL, i);
         }
     }
     if (oldest_idx == -1) return nullptr;
@@ -181,8 +381,50 @@ fft_result_t *fft_find_and_lock_latest_result() {
             } else {
                 fft_results[i].mutex.unlock();
             }
+        } else {
+            trace_record(TRACE_TRYLOCK_FAIL, i);
         }
     }
     if (newest_idx == -1) return nullptr;
     return &fft_results[newest_idx];
 }
+
+#ifdef PLACEMENT_BENCH
+void fft_stage_bench_run() {
+    profile_counter_enable();
+
+    // Own FFT instance: this may run before fft_init() in the threaded build.
+    static arm_rfft_fast_instance_f32 handler;
+    static float32_t magnitude[FFT_BUFFER_SIZE / 2];
+    static float32_t psd[FFT_BUFFER_SIZE / 2];
+    arm_rfft_fast_init_f32(&handler, FFT_BUFFER_SIZE);
+    uint32_t cycles[4] = {0, 0, 0, 0};
+
+    for (int round = 0; round < FFT_STAGE_BENCH_ROUNDS; round++) {
+        uint32_t t0 = profile_counter_now();
+        fft_load_window(sensor_data_buffer.window(IMU_RAW_GYRO), 0, FFT_BUFFER_SIZE, IMU_GYRO_SCALE);
+        uint32_t t1 = profile_counter_now();
+        arm_rfft_fast_f32(&handler, fft_input, fft_output, 0);
+        uint32_t t2 = profile_counter_now();
+        arm_cmplx_mag_f32(fft_output, magnitude, FFT_BUFFER_SIZE / 2);
+        uint32_t t3 = profile_counter_now();
+        arm_mult_f32(magnitude, magnitude, psd, FFT_BUFFER_SIZE / 2);
+        arm_scale_f32(psd, scale_factor, psd, FFT_BUFFER_SIZE / 2);
+        uint32_t t4 = profile_counter_now();
+        cycles[0] += t1 - t0;
+        cycles[1] += t2 - t1;
+        cycles[2] += t3 - t2;
+        cycles[3] += t4 - t3;
+    }
+
+#ifdef MEM_PLACEMENT
+    const char *placement = "MEM_PLACEMENT";
+#else
+    const char *placement = "default";
+#endif
+    LOG_INFO("FFT stage cycles (%s, N=%d, one axis): load %" PRIu32 " | rfft %" PRIu32 " | magnitude %" PRIu32 " | psd %" PRIu32,
+        placement, FFT_BUFFER_SIZE,
+        cycles[0] / FFT_STAGE_BENCH_ROUNDS, cycles[1] / FFT_STAGE_BENCH_ROUNDS,
+        cycles[2] / FFT_STAGE_BENCH_ROUNDS, cycles[3] / FFT_STAGE_BENCH_ROUNDS);
+}
+#endif
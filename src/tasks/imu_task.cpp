@@ -3,53 +3,466 @@
  * @brief Implementation of the IMU sampling/publishing RTOS task.
  */
 
+#define LOG_MODULE LOG_MODULE_IMU
+
 #include "tasks/imu_task.hpp"
 #include "mbed.h"
 #include "logger.hpp"
 #include "main.hpp"
+#include "task_monitor.hpp"
+#include "adaptive_odr.hpp"
+#include "activity_gate.hpp"
+#include "trace.hpp"
+#include "imu_fifo_drain.hpp"
+#include "hal/us_ticker_api.h"
+#include <atomic>
+
+
+static Mail<imu_data_t, IMU_MAILBOX_DEPTH> imu_mail_box_storage;
+static_assert(sizeof(imu_mail_box_storage) == IMU_MAILBOX_BYTES, "update IMU_MAILBOX_BYTES");
+Mail<imu_data_t, IMU_MAILBOX_DEPTH> *imu_mail_box = nullptr;
+
+static task_monitor_t imu_monitor;
+
+
+// Nominal data-ready period in us.
+#define IMU_PERIOD_US (1000000 / IMU_SAMPLE_RATE_HZ)
+
+// Data-ready timing accumulated since the last report.
+static uint32_t timing_last_edge_us = 0;
+static bool timing_have_edge = false;
+static uint32_t timing_intervals = 0;
+static uint32_t timing_interval_min_us = UINT32_MAX;
+static uint32_t timing_interval_max_us = 0;
+static uint32_t timing_jitter_sum_us = 0;
+static uint32_t timing_jitter_max_us = 0;
+static uint32_t timing_samples = 0;
+static uint32_t timing_delay_sum_us = 0;
+static uint32_t timing_delay_max_us = 0;
+static uint32_t timing_missed_edges = 0;
+
+// Sequence number of the current data-ready edge.
+static uint32_t imu_seq = 0;
+static uint32_t imu_seq_reported = 0;
+
+static const char *imu_drop_source_names[IMU_DROP_SOURCE_COUNT] = {
+    "mailbox",
+    "bus",
+    "busy",
+    "missed",
+    "fifo"
+};
+
+// Lost samples per source; bus errors are also counted from the transfer
+// completion interrupt.
+static std::atomic<uint32_t> imu_drops[IMU_DROP_SOURCE_COUNT];
+
+static void imu_drop(imu_drop_source_t source, uint32_t count) {
+    imu_drops[source] += count;
+    trace_record(TRACE_IMU_DROP, source);
+}
+
+// Edges dropped before reaching imu_sample_read() (pipeline queue full) whose
+// gap has not been seen by imu_edge_record() yet.
+static std::atomic<uint32_t> imu_edges_unqueued;
+
+void imu_edge_unqueued() {
+    imu_edges_unqueued++;
+}
 
+// Account for one data-ready activation: sequence number and timing
+// statistics. Edges that were never handled (the interval spans several
+// periods) advance the sequence too, so consumers see them as a gap.
+static void imu_edge_record(uint32_t edge_us) {
+    uint32_t delay_us = us_ticker_read() - edge_us;
 
-Mail<imu_data_t, 10> *imu_mail_box = nullptr;
+    timing_samples++;
+    timing_delay_sum_us += delay_us;
+    if (delay_us > timing_delay_max_us) timing_delay_max_us = delay_us;
 
+    if (!timing_have_edge) {
+        imu_seq++;
+    } else if (edge_us != timing_last_edge_us) {
+        // Unsigned subtraction handles ticker wrap-around.
+        uint32_t interval = edge_us - timing_last_edge_us;
+        uint32_t jitter = interval > IMU_PERIOD_US ? interval - IMU_PERIOD_US : IMU_PERIOD_US - interval;
+        timing_intervals++;
+        timing_jitter_sum_us += jitter;
+        if (jitter > timing_jitter_max_us) timing_jitter_max_us = jitter;
+        if (interval < timing_interval_min_us) timing_interval_min_us = interval;
+        if (interval > timing_interval_max_us) timing_interval_max_us = interval;
+
+        // Whole periods since the last edge; each one beyond the first is lost.
+        uint32_t periods = (interval + IMU_PERIOD_US / 2) / IMU_PERIOD_US;
+        uint32_t missed = periods > 1 ? periods - 1 : 0;
+        if (missed) {
+            timing_missed_edges += missed;
+            // Edges the pipeline queue refused are already known; charge them
+            // to the queue and only the rest to the task being late.
+            uint32_t pending = imu_edges_unqueued.load();
+            uint32_t unqueued;
+            do {
+                unqueued = pending < missed ? pending : missed;
+            } while (!imu_edges_unqueued.compare_exchange_weak(pending, pending - unqueued));
+            if (unqueued) {
+                imu_drop(IMU_DROP_MAILBOX_FULL, unqueued);
+            }
+            if (missed > unqueued) {
+                imu_drop(IMU_DROP_MISSED_EDGE, missed - unqueued);
+            }
+        }
+        imu_seq += 1 + missed;
+    }
+    timing_last_edge_us = edge_us;
+    timing_have_edge = true;
+}
+
+// Stamp a sample with the interrupt time and sequence number of the current edge.
+static void imu_sample_stamp(imu_data_t *sample) {
+    sample->timestamp_us = timing_last_edge_us;
+    sample->seq = imu_seq;
+}
+
+void imu_timing_get_and_reset(imu_timing_stats_t *stats) {
+    stats->samples = timing_samples;
+    stats->interval_min_us = timing_intervals ? timing_interval_min_us : 0;
+    stats->interval_max_us = timing_interval_max_us;
+    stats->jitter_avg_us = timing_intervals ? timing_jitter_sum_us / timing_intervals : 0;
+    stats->jitter_max_us = timing_jitter_max_us;
+    stats->read_delay_avg_us = timing_samples ? timing_delay_sum_us / timing_samples : 0;
+    stats->read_delay_max_us = timing_delay_max_us;
+    stats->missed_edges = timing_missed_edges;
+
+    timing_intervals = 0;
+    timing_interval_min_us = UINT32_MAX;
+    timing_interval_max_us = 0;
+    timing_jitter_sum_us = 0;
+    timing_jitter_max_us = 0;
+    timing_samples = 0;
+    timing_delay_sum_us = 0;
+    timing_delay_max_us = 0;
+    timing_missed_edges = 0;
+}
+
+void imu_drops_get_and_reset(imu_drop_stats_t *stats) {
+    uint32_t seq = imu_seq;
+    stats->produced = seq - imu_seq_reported;
+    imu_seq_reported = seq;
+    for (int i = 0; i < IMU_DROP_SOURCE_COUNT; i++) {
+        stats->dropped[i] = imu_drops[i].exchange(0);
+    }
+}
+
+const char *imu_drop_source_name(imu_drop_source_t source) {
+    return source < IMU_DROP_SOURCE_COUNT ? imu_drop_source_names[source] : "?";
+}
+
+bool imu_sample_read(imu_data_t *sample, uint32_t edge_us) {
+    imu_edge_record(edge_us);
+    imu_sample_stamp(sample);
+
+    // One burst transaction for both sensors; scaling happens per window.
+    if (!imu_read_raw(sample->raw)) {
+        LOG_WARN("Failed to read IMU data");
+        imu_drop(IMU_DROP_BUS_ERROR, 1);
+        return false;
+    }
+
+    LOG_DEBUG("gyro: %d, %d, %d | accel: %d, %d, %d", sample->raw[0], sample->raw[1], sample->raw[2], sample->raw[3], sample->raw[4], sample->raw[5]);
+    return true;
+}
+
+#ifdef IMU_ADAPTIVE_ODR
+/**
+ * @brief Apply rate switches requested by the adaptive-ODR logic.
+ *
+ * Called on every data-ready edge before the normal sample path. In REST the
+ * low-rate sample is read synchronously and only checked for motion.
+ *
+ * @return true if the activation was consumed here (nothing to publish).
+ */
+static bool imu_adaptive_odr_step() {
+    adaptive_odr_state_t state = adaptive_odr_get_state();
+    if (state == ADAPTIVE_ODR_ACTIVE) {
+        return false;
+    }
+
+    if (state == ADAPTIVE_ODR_REST_PENDING) {
+#if DEVICE_I2C_ASYNCH
+        if (imu_read_async_busy()) {
+            return false;
+        }
+#endif
+        if (!imu_set_odr(CTRL_ODR_26HZ)) {
+            LOG_WARN("Failed to lower IMU rate");
+            return false;
+        }
+        adaptive_odr_enter_rest();
+        LOG_INFO("IMU at rest: %d Hz", ADAPTIVE_ODR_REST_HZ);
+        return true;
+    }
+
+    float32_t accel[3], gyro[3];
+    if (!imu_read_data(accel, gyro)) {
+        LOG_WARN("Failed to read IMU data");
+        return true;
+    }
+    if (adaptive_odr_check_motion(accel, gyro)) {
+        if (!imu_set_odr(CTRL_ODR_208HZ)) {
+            LOG_WARN("Failed to restore IMU rate");
+            return true;
+        }
+        adaptive_odr_wake();
+        // The pause is neither jitter nor a deadline miss.
+        timing_have_edge = false;
+        task_monitor_resync(&imu_monitor);
+        LOG_INFO("IMU active: %d Hz", IMU_SAMPLE_RATE_HZ);
+    }
+    return true;
+}
+#endif
+
+#ifdef IMU_ACTIVITY_GATING
+/**
+ * @brief Run the activity gate on the current data-ready edge.
+ * @return true if the activation was consumed here (nothing to publish).
+ */
+static bool imu_activity_gate_step() {
+    activity_gate_edge_t edge = activity_gate_step(imu_data_ready_time_us());
+    if (edge == ACTIVITY_GATE_EDGE_OPENED) {
+        // The pause is neither jitter nor a deadline miss; this edge still
+        // belongs to the sleep rate, so publishing starts with the next one.
+        timing_have_edge = false;
+        task_monitor_resync(&imu_monitor);
+    }
+    return edge != ACTIVITY_GATE_EDGE_PUBLISH;
+}
+#endif
+
+#if DEVICE_I2C_ASYNCH && !defined(IMU_FIFO_MODE)
+// Mailbox slot being filled by the in-flight transfer.
+static imu_data_t *imu_async_slot = nullptr;
+static std::atomic<uint32_t> imu_async_errors(0);
+
+// Transfer completion (interrupt context): the raw words already sit in the
+// slot, so publishing is all that is left.
+static void imu_async_complete(bool ok) {
+    imu_data_t *slot = imu_async_slot;
+    imu_async_slot = nullptr;
+    if (!ok) {
+        imu_async_errors++;
+        imu_drop(IMU_DROP_BUS_ERROR, 1);
+        imu_mail_box->free(slot);
+        return;
+    }
+    // Consumer is responsible for free().
+    trace_record(TRACE_MAIL_PUT, slot->seq);
+    imu_mail_box->put(slot);
+}
+
+/**
+ * @brief Asynchronous loop: start the bus transfer on each data-ready edge and
+ *        let the completion interrupt publish the sample.
+ *
+ * The thread only reserves a mailbox slot, stamps it with the edge time and starts the
+ * transfer, so it no longer blocks for the bus time of every sample.
+ */
+static void imu_async_loop() {
+    while (true) {
+        // Block until the IMU raises its data-ready interrupt.
+        if (!imu_data_wait(1000)) {
+            LOG_FATAL("IMU data wait timeout");
+            trigger_fatal_error();
+            return;
+        }
+#ifdef IMU_ADAPTIVE_ODR
+        if (imu_adaptive_odr_step()) {
+            continue;
+        }
+#endif
+#ifdef IMU_ACTIVITY_GATING
+        if (imu_activity_gate_step()) {
+            continue;
+        }
+#endif
+        task_monitor_begin(&imu_monitor);
+        imu_edge_record(imu_data_ready_time_us());
+
+        uint32_t errors = imu_async_errors.exchange(0);
+        if (errors != 0) {
+            LOG_WARN("Failed to read IMU data (%u)", (unsigned)errors);
+        }
+
+        if (imu_read_async_busy()) {
+            // Previous transfer still running: drop this edge.
+            LOG_WARN("IMU transfer overrun");
+            imu_drop(IMU_DROP_BUS_BUSY, 1);
+            task_monitor_end(&imu_monitor);
+            continue;
+        }
+
+        imu_data_t *imu_data = imu_mail_box->try_alloc();
+        if (imu_data == nullptr) {
+            LOG_WARN("Failed to allocate IMU mail box");
+            imu_drop(IMU_DROP_MAILBOX_FULL, 1);
+            task_monitor_end(&imu_monitor);
+            continue;
+        }
+
+        imu_sample_stamp(imu_data);
+        imu_async_slot = imu_data;
+        if (!imu_read_raw_async(imu_data->raw, imu_async_complete)) {
+            imu_async_slot = nullptr;
+            imu_mail_box->free(imu_data);
+            LOG_WARN("Failed to start IMU transfer");
+            imu_drop(IMU_DROP_BUS_ERROR, 1);
+        }
+        task_monitor_end(&imu_monitor);
+    }
+}
+#endif
+
+#ifdef IMU_FIFO_MODE
+// imu_fifo_drain() sink: stamp one sample into a mailbox slot.
+static void imu_fifo_publish(const int16_t *raw, uint32_t timestamp_us, uint32_t seq) {
+    // The sensor FIFO keeps buffering while we wait for a slot.
+    imu_data_t *imu_data = imu_mail_box->try_alloc_for(IMU_FIFO_ALLOC_TIMEOUT);
+    if (imu_data == nullptr) {
+        LOG_WARN("Failed to allocate IMU mail box");
+        imu_drop(IMU_DROP_MAILBOX_FULL, 1);
+        return;
+    }
+    memcpy(imu_data->raw, raw, sizeof(imu_data->raw));
+    imu_data->timestamp_us = timestamp_us;
+    imu_data->seq = seq;
+    trace_record(TRACE_MAIL_PUT, imu_data->seq);
+    imu_mail_box->put(imu_data);
+}
+
+/**
+ * @brief FIFO-mode loop: wake on the watermark and publish the whole batch.
+ *
+ * Timestamps come from the ODR grid of imu_fifo_clock (see
+ * imu_fifo_clock.hpp). The jitter statistics do not apply here: spacing is
+ * exact by construction.
+ *
+ * Every sample slot takes a sequence number. Samples lost to an overrun or a
+ * failed read are estimated by the clock at the next batch, so they show up
+ * as a gap downstream.
+ */
+static void imu_fifo_loop() {
+    if (!imu_fifo_enable(IMU_FIFO_WATERMARK_SAMPLES)) {
+        LOG_FATAL("Failed to enable IMU FIFO");
+        trigger_fatal_error();
+        return;
+    }
+    LOG_INFO("IMU FIFO mode, watermark %d samples", IMU_FIFO_WATERMARK_SAMPLES);
+
+    imu_fifo_clock_t clock;
+    imu_fifo_clock_init(&clock, IMU_SAMPLE_RATE_HZ);
+    int idle_polls = 0;
+
+    while (true) {
+        // Watermark edge, or a periodic poll in case an edge was missed.
+        imu_data_wait(IMU_FIFO_WAIT_TIMEOUT_MS);
+        task_monitor_begin(&imu_monitor);
+
+        imu_fifo_batch_t batch;
+        imu_fifo_drain(&clock, &imu_seq, imu_fifo_publish, &batch);
+        if (batch.available < 0) {
+            LOG_WARN("Failed to read IMU FIFO status");
+            task_monitor_end(&imu_monitor);
+            continue;
+        }
+        if (batch.available == 0) {
+            task_monitor_end(&imu_monitor);
+            if (++idle_polls >= IMU_FIFO_MAX_IDLE_POLLS) {
+                LOG_FATAL("IMU FIFO stalled");
+                trigger_fatal_error();
+                return;
+            }
+            continue;
+        }
+        idle_polls = 0;
+        if (batch.overrun) {
+            LOG_WARN("IMU FIFO overrun");
+        }
+        if (batch.lost) {
+            imu_drop(IMU_DROP_FIFO_OVERRUN, batch.lost);
+        }
+        if (batch.read_failed) {
+            LOG_WARN("Failed to read IMU FIFO data");
+            imu_drop(IMU_DROP_BUS_ERROR, batch.read_failed);
+        }
+        task_monitor_end(&imu_monitor);
+    }
+}
+#endif
 
 void imu_task() {
     LOG_INFO("IMU Task Started");
 
-    // Allocate the mailbox used to pass samples to other tasks (e.g., FFT).
-    imu_mail_box = new Mail<imu_data_t, 10>();
-    if (!imu_mail_box) {
-        LOG_ERROR("Failed to create IMU mail box");
+    // Publish the mailbox used to pass samples to other tasks (e.g., FFT).
+    imu_mail_box = &imu_mail_box_storage;
+
+#ifdef IMU_FIFO_MODE
+    // One activation per watermark batch; the budget covers the batch read
+    // plus waiting for mailbox slots.
+    task_monitor_register(&imu_monitor, "imu", TASK_MONITOR_PERIOD_US(IMU_SAMPLE_RATE_HZ) * IMU_FIFO_WATERMARK_SAMPLES,
+        TASK_MONITOR_PERIOD_US(IMU_SAMPLE_RATE_HZ) * IMU_FIFO_WATERMARK_SAMPLES);
+    imu_fifo_loop();
+    return;
+#endif
+
+    task_monitor_register(&imu_monitor, "imu", TASK_MONITOR_PERIOD_US(IMU_SAMPLE_RATE_HZ), IMU_TASK_BUDGET_US);
+
+#ifdef IMU_ACTIVITY_GATING
+    if (!imu_activity_enable(ACTIVITY_GATE_WAKE_THS, ACTIVITY_GATE_SLEEP_DUR)) {
+        LOG_FATAL("Failed to enable IMU activity detection");
         trigger_fatal_error();
         return;
     }
+#endif
+
+#if DEVICE_I2C_ASYNCH && !defined(IMU_FIFO_MODE)
+    imu_async_loop();
+    return;
+#endif
 
     while (true) {
         // Block until the IMU raises its data-ready interrupt.
         if (imu_data_wait(1000)) {
+#ifdef IMU_ADAPTIVE_ODR
+            if (imu_adaptive_odr_step()) {
+                continue;
+            }
+#endif
+#ifdef IMU_ACTIVITY_GATING
+            if (imu_activity_gate_step()) {
+                continue;
+            }
+#endif
+            task_monitor_begin(&imu_monitor);
             LOG_DEBUG("IMU data ready");
 
             imu_data_t *imu_data = imu_mail_box->try_alloc();
             if (imu_data != nullptr) {
 
-                imu_data->timestamp = Kernel::Clock::now();
-
-                if (!imu_read_acc_data(imu_data->accel)) {
-                    LOG_WARN("Failed to read accel data");
-                    imu_mail_box->free(imu_data);
-                    continue;
-                }
-
-                if (!imu_read_gyro_data(imu_data->gyro)) {
-                    LOG_WARN("Failed to read gyro data");
+                if (!imu_sample_read(imu_data, imu_data_ready_time_us())) {
                     imu_mail_box->free(imu_data);
+                    task_monitor_end(&imu_monitor);
                     continue;
                 }
 
-                LOG_DEBUG("accel: %.2f, %.2f, %.2f | gyro: %.2f, %.2f, %.2f", imu_data->accel[0], imu_data->accel[1], imu_data->accel[2], imu_data->gyro[0], imu_data->gyro[1], imu_data->gyro[2]);
                 // Publish sample to consumers; consumer is responsible for free().
+                trace_record(TRACE_MAIL_PUT, imu_data->seq);
                 imu_mail_box->put(imu_data);
+                task_monitor_end(&imu_monitor);
             } else {
                 LOG_WARN("Failed to allocate IMU mail box");
+                imu_edge_record(imu_data_ready_time_us());
+                imu_drop(IMU_DROP_MAILBOX_FULL, 1);
+                task_monitor_end(&imu_monitor);
                 continue;
             }
         } else {
@@ -59,4 +472,4 @@ void imu_task() {
         }
         ThisThread::sleep_for(1ms);
     }
-}
\ No newline at end of file
+}
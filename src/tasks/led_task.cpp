@@ -1,42 +1,70 @@
 /**
  * @file led_task.cpp
  * @brief LED status patterns for tremor/dyskinesia/FOG and BLE connection.
+ *
+ * The task sleeps on the motion status word, so a new detection is shown as
+ * soon as it is published. The 50 ms timeout drives the breathing animation
+ * and the FOG blink pattern.
  */
 
+#define LOG_MODULE LOG_MODULE_LED
+
 #include "tasks/led_task.hpp"
 #include "mbed.h"
 #include "bsp/led.hpp"
 #include "logger.hpp"
-#include "tasks/analysis_task.hpp"
+#include "motion_status.hpp"
 #include "tasks/ble_task.hpp"
+#include "task_monitor.hpp"
+#include "latency.hpp"
 
-void led_task() {
-    LOG_INFO("LED Task Started");
+#define LED_FOG_BLINK_PERIOD 500ms
 
-    float led_value = 0.0f;
-    bool led_direction = true;
+static float led_value = 0.0f;
+static bool led_direction = true;
+static uint8_t led_last_flags = 0;
+static uint32_t led_rendered_generation = 0;
+static Kernel::Clock::time_point led_fog_start;
+static Kernel::Clock::time_point led_next_tick;
 
-    while (true) {
-        // Primary status indication from the analysis task:
-        // - FOG: blink blue/yellow
-        // - Dyskinesia: steady yellow
-        // - Tremor: steady blue
-        // - None: off
-        if (get_fog_status()) {
-            for (int i = 0; i < 5; i++) {
-                led_blue_yellow_on();
-                ThisThread::sleep_for(500ms);
-                led_blue_yellow_off();
-                ThisThread::sleep_for(500ms);
-            }
-        } else if (get_dyskinesia_status()) {
-            led_yellow_on();
-        } else if (get_tremor_status()) {
-            led_blue_on();
+Kernel::Clock::duration led_step() {
+    auto now = Kernel::Clock::now();
+    motion_status_t status = motion_status_get();
+
+    // Restart the blink phase when FOG is first reported.
+    if ((status.flags & MOTION_STATUS_FOG) && !(led_last_flags & MOTION_STATUS_FOG)) {
+        led_fog_start = now;
+    }
+    led_last_flags = status.flags;
+    bool status_changed = status.generation != led_rendered_generation;
+    led_rendered_generation = status.generation;
+
+    // Primary status indication from the analysis task:
+    // - FOG: blink blue/yellow
+    // - Dyskinesia: steady yellow
+    // - Tremor: steady blue
+    // - None: off
+    if (status.flags & MOTION_STATUS_FOG) {
+        bool blink_on = ((now - led_fog_start) / LED_FOG_BLINK_PERIOD) % 2 == 0;
+        if (blink_on) {
+            led_blue_yellow_on();
         } else {
             led_blue_yellow_off();
         }
-        
+    } else if (status.flags & MOTION_STATUS_DYSKINESIA) {
+        led_yellow_on();
+    } else if (status.flags & MOTION_STATUS_TREMOR) {
+        led_blue_on();
+    } else {
+        led_blue_yellow_off();
+    }
+    if (status_changed) {
+        latency_record_output(LATENCY_DECISION_TO_LED, LATENCY_SAMPLE_TO_LED, status.generation);
+    }
+
+    if (now >= led_next_tick) {
+        // Resynchronize instead of replaying missed ticks (e.g. on first call).
+        led_next_tick = (now - led_next_tick > LED_TICK_PERIOD) ? now + LED_TICK_PERIOD : led_next_tick + LED_TICK_PERIOD;
 
         // Secondary status: BLE connection on green LED2.
         if (ble_is_connected()) {
@@ -58,7 +86,26 @@ void led_task() {
             }
         }
         led_green_1_set(led_value);
-        ThisThread::sleep_for(50ms);
+    }
+
+    now = Kernel::Clock::now();
+    return led_next_tick > now ? led_next_tick - now : Kernel::Clock::duration(0);
+}
+
+void led_task() {
+    LOG_INFO("LED Task Started");
+
+    // Status changes add extra, shorter activations; only late ticks count as misses.
+    static task_monitor_t led_monitor;
+    task_monitor_register(&led_monitor, "led", (uint32_t)chrono::microseconds(LED_TICK_PERIOD).count(), LED_TASK_BUDGET_US);
+
+    while (true) {
+        task_monitor_begin(&led_monitor);
+        Kernel::Clock::duration timeout = led_step();
+        task_monitor_end(&led_monitor);
 
+        // Wake on the next animation tick or immediately on a status change.
+        motion_status_t status;
+        motion_status_wait(MOTION_STATUS_WAITER_LED, led_rendered_generation, timeout, &status);
     }
-}
\ No newline at end of file
+}
@@ -6,46 +6,165 @@
  * profiling rather than core functionality.
  */
 
+#define LOG_MODULE LOG_MODULE_TEST
+
 #include "tasks/test_task.hpp"
 #include "mbed.h"
 #include "mbed_stats.h"
 #include <inttypes.h>
 #include "logger.hpp"
 #include "main.hpp"
+#include "pipeline.hpp"
+#include "task_monitor.hpp"
+#include "governor.hpp"
+#include "tasks/fft_task.hpp"
+#include "tasks/analysis_task.hpp"
+#include "tasks/imu_task.hpp"
+#include "adaptive_odr.hpp"
+#include "activity_gate.hpp"
+#include "numeric.hpp"
+#include "buffer.hpp"
+#include "profiler.hpp"
+#include "latency.hpp"
+#include "trace.hpp"
 
 
 uint64_t prev_idle_time = 0;
-#define SAMPLE_TIME_MS 2000
+uint64_t prev_uptime = 0;
 
 
-void test_task() {
-    LOG_INFO("Test Task Started");
+static mbed_stats_thread_t thread_stats[TEST_MAX_THREADS];
+static_assert(sizeof(thread_stats) == TEST_THREAD_STATS_BYTES, "update TEST_THREAD_STATS_BYTES");
+
+// Largest stack use logged so far, per thread id.
+static uint32_t stack_peak_ids[TEST_MAX_THREADS];
+static uint32_t stack_peak_bytes[TEST_MAX_THREADS];
+
 
-    mbed_stats_thread_t *thread_stats = new mbed_stats_thread_t[8];
+// Log a thread's stack high-water mark when it grows, and warn when it leaves
+// less than TEST_STACK_MARGIN_PCT of the stack unused.
+static void test_check_stack(const mbed_stats_thread_t *stats) {
+    uint32_t used = stats->stack_size - stats->stack_space;
 
+    // Threads are never removed, so known ids come before the free slots.
+    int slot = -1;
+    for (int i = 0; i < TEST_MAX_THREADS && slot < 0; i++) {
+        if (stack_peak_ids[i] == stats->id || stack_peak_ids[i] == 0) {
+            slot = i;
+        }
+    }
+    if (slot >= 0 && used > stack_peak_bytes[slot]) {
+        stack_peak_ids[slot] = stats->id;
+        stack_peak_bytes[slot] = used;
+        LOG_INFO("Stack peak %s: %" PRIu32 " of %" PRIu32 " B", stats->name, used, stats->stack_size);
+    }
+
+    if ((uint64_t)stats->stack_space * 100 < (uint64_t)stats->stack_size * TEST_STACK_MARGIN_PCT) {
+        LOG_WARN("Stack margin low %s: %" PRIu32 " of %" PRIu32 " B used, less than %d%% free",
+            stats->name, used, stats->stack_size, TEST_STACK_MARGIN_PCT);
+    }
+}
+
+
+void test_init() {
     mbed_stats_cpu_t cpu_stats;
     mbed_stats_cpu_get(&cpu_stats);
     prev_idle_time = cpu_stats.idle_time;
+    prev_uptime = cpu_stats.uptime;
 
-    ThisThread::sleep_for(SAMPLE_TIME_MS * 1ms);
+#ifdef NUMERIC_BENCH
+    numeric_bench_run();
+#endif
+#ifdef BUFFER_BENCH
+    buffer_bench_run();
+#endif
+#ifdef PLACEMENT_BENCH
+    fft_stage_bench_run();
+#endif
+}
 
-    while (true) {
-        int count = mbed_stats_thread_get_each(thread_stats, 8);
-        for (int i = 0; i < count; i++) {
-            LOG_DEBUG("ID: 0x%" PRIx32 " Name: %s State: %" PRId32 " Priority: %" PRId32 " Stack Size: %" PRId32 " Stack Space: %" PRId32, thread_stats[i].id, thread_stats[i].name, thread_stats[i].state, thread_stats[i].priority, thread_stats[i].stack_size, thread_stats[i].stack_space);
-        }
-        
-        mbed_stats_cpu_get(&cpu_stats);
+void test_report() {
+    int count = mbed_stats_thread_get_each(thread_stats, TEST_MAX_THREADS);
+    for (int i = 0; i < count; i++) {
+        LOG_DEBUG("ID: 0x%" PRIx32 " Name: %s State: %" PRId32 " Priority: %" PRId32 " Stack Size: %" PRId32 " Stack Space: %" PRId32, thread_stats[i].id, thread_stats[i].name, thread_stats[i].state, thread_stats[i].priority, thread_stats[i].stack_size, thread_stats[i].stack_space);
+        test_check_stack(&thread_stats[i]);
+    }
     
-        // Compute CPU usage from idle time delta over the sampling period.
-        uint64_t diff_usec = (cpu_stats.idle_time - prev_idle_time);
-        uint8_t idle = (diff_usec * 100) / (SAMPLE_TIME_MS * 1000);
-        uint8_t usage = 100 - idle;
-        prev_idle_time = cpu_stats.idle_time;
-        
-        // Print summary.
-        LOG_DEBUG("CPU Usage: %d%%   Idle: %d%%", usage, idle);
+    mbed_stats_cpu_t cpu_stats;
+    mbed_stats_cpu_get(&cpu_stats);
 
+    // Compute CPU usage from the idle time delta over the measured interval
+    // since the last report (longer than SAMPLE_TIME_MS by the report itself).
+    uint64_t idle_usec = cpu_stats.idle_time - prev_idle_time;
+    uint64_t elapsed_usec = cpu_stats.uptime - prev_uptime;
+    uint32_t idle = elapsed_usec ? (uint32_t)(idle_usec * 100 / elapsed_usec) : 100;
+    if (idle > 100) {
+        idle = 100;
+    }
+    uint32_t usage = 100 - idle;
+    prev_idle_time = cpu_stats.idle_time;
+    prev_uptime = cpu_stats.uptime;
+    
+    // Print summary.
+    LOG_DEBUG("CPU Usage: %" PRIu32 "%%   Idle: %" PRIu32 "%%", usage, idle);
+
+    // Adapt spectral quality to the measured load.
+    governor_update((uint8_t)usage, fft_backlog_get_and_reset());
+
+    imu_drop_stats_t drops;
+    imu_drops_get_and_reset(&drops);
+    uint32_t dropped = 0;
+    for (int i = 0; i < IMU_DROP_SOURCE_COUNT; i++) {
+        dropped += drops.dropped[i];
+    }
+    // Drop rate in hundredths of a percent.
+    uint32_t drop_rate = drops.produced ? (uint32_t)((uint64_t)dropped * 10000 / drops.produced) : 0;
+    LOG_INFO("IMU drops: %" PRIu32 " of %" PRIu32 " (%" PRIu32 ".%02" PRIu32 "%%) | %s %" PRIu32 " %s %" PRIu32 " %s %" PRIu32 " %s %" PRIu32 " %s %" PRIu32,
+        dropped, drops.produced, drop_rate / 100, drop_rate % 100,
+        imu_drop_source_name(IMU_DROP_MAILBOX_FULL), drops.dropped[IMU_DROP_MAILBOX_FULL],
+        imu_drop_source_name(IMU_DROP_BUS_ERROR), drops.dropped[IMU_DROP_BUS_ERROR],
+        imu_drop_source_name(IMU_DROP_BUS_BUSY), drops.dropped[IMU_DROP_BUS_BUSY],
+        imu_drop_source_name(IMU_DROP_MISSED_EDGE), drops.dropped[IMU_DROP_MISSED_EDGE],
+        imu_drop_source_name(IMU_DROP_FIFO_OVERRUN), drops.dropped[IMU_DROP_FIFO_OVERRUN]);
+
+    fft_gap_stats_t gaps;
+    fft_gaps_get_and_reset(&gaps);
+    LOG_INFO("Window gaps: %" PRIu32 " | interpolated %" PRIu32 " samples | restarts %" PRIu32 " | stale %" PRIu32,
+        gaps.gaps, gaps.interpolated, gaps.restarts, gaps.stale);
+
+    imu_timing_stats_t timing;
+    imu_timing_get_and_reset(&timing);
+    LOG_INFO("IMU timing: n %" PRIu32 " | interval %" PRIu32 "..%" PRIu32 " us | jitter avg %" PRIu32 " max %" PRIu32 " us"
+              " | read delay avg %" PRIu32 " max %" PRIu32 " us | missed %" PRIu32,
+        timing.samples, timing.interval_min_us, timing.interval_max_us, timing.jitter_avg_us, timing.jitter_max_us,
+        timing.read_delay_avg_us, timing.read_delay_max_us, timing.missed_edges);
+
+    task_monitor_report();
+    profile_report();
+    latency_report();
+    trace_poll_command();
+
+#ifdef IMU_ADAPTIVE_ODR
+    adaptive_odr_report();
+#endif
+#ifdef IMU_ACTIVITY_GATING
+    activity_gate_report();
+#endif
+
+#ifdef PIPELINE_SINGLE_THREAD
+    pipeline_report();
+#endif
+}
+
+void test_task() {
+    LOG_INFO("Test Task Started");
+
+    test_init();
+
+    ThisThread::sleep_for(SAMPLE_TIME_MS * 1ms);
+
+    while (true) {
+        test_report();
         ThisThread::sleep_for(SAMPLE_TIME_MS * 1ms);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,125 @@
+/**
+ * @file trace.cpp
+ * @brief Implementation of the trace ring, the thread switch hook and the dump.
+ */
+
+#ifdef TRACE_BUFFER
+
+#define LOG_MODULE LOG_MODULE_TEST
+
+#include "trace.hpp"
+#include "mbed.h"
+#include <inttypes.h>
+#include "logger.hpp"
+#include "bsp/serial.hpp"
+#include "profiler.hpp"
+#include "tasks/imu_task.hpp"
+
+trace_event_t g_trace_ring[TRACE_EVENTS];
+std::atomic<uint32_t> g_trace_head(0);
+std::atomic<bool> g_trace_enabled(false);
+
+// Threads seen by the switch hook. Only the hook appends (the scheduler does
+// not nest), and the dump reads the published count.
+static osThreadId_t trace_threads[TRACE_MAX_THREADS];
+static std::atomic<uint32_t> trace_thread_count(0);
+
+// Whether the first report has checked that the switch hook is linked in.
+static bool trace_hook_checked = false;
+
+// Small index for a thread id; threads beyond the table share TRACE_MAX_THREADS.
+static uint32_t trace_thread_index(osThreadId_t thread_id) {
+    uint32_t count = trace_thread_count.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < count; i++) {
+        if (trace_threads[i] == thread_id) {
+            return i;
+        }
+    }
+    if (count == TRACE_MAX_THREADS) {
+        return TRACE_MAX_THREADS;
+    }
+    trace_threads[count] = thread_id;
+    trace_thread_count.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+/**
+ * @brief RTX event hook, called by the scheduler on every thread switch.
+ *
+ * Overrides the weak definition in RTX's rtx_evr.c. It runs in handler mode,
+ * so the thread names are resolved later by the dump.
+ */
+extern "C" void EvrRtxThreadSwitched(osThreadId_t thread_id) {
+    if (g_trace_enabled.load(std::memory_order_relaxed)) {
+        trace_record(TRACE_THREAD_SWITCH, trace_thread_index(thread_id));
+    }
+}
+
+void trace_init() {
+    profile_counter_enable();
+    g_trace_enabled.store(true, std::memory_order_relaxed);
+    LOG_INFO("Trace buffer: %d events, send '%c' to dump", TRACE_EVENTS, TRACE_DUMP_COMMAND);
+}
+
+void trace_dump() {
+    // A probe interrupted before this point may still complete one slot.
+    g_trace_enabled.store(false, std::memory_order_relaxed);
+    uint32_t head = g_trace_head.load(std::memory_order_relaxed);
+    uint32_t count = head < TRACE_EVENTS ? head : TRACE_EVENTS;
+    uint32_t threads = trace_thread_count.load(std::memory_order_acquire);
+
+    // One block under the serial lock, so log lines cannot interleave.
+    serial_lock();
+    printf("TRACE BEGIN %" PRIu32 " %" PRIu32 " %" PRIu32 "\n", profile_counter_hz(), count, head - count);
+    for (uint32_t i = 0; i < threads; i++) {
+        const char *name = osThreadGetName(trace_threads[i]);
+        printf("TRACE THREAD %" PRIu32 " %s\n", i, name != nullptr ? name : "?");
+    }
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        printf("TRACE STAGE %d %s\n", i, profile_stage_name((profile_stage_t)i));
+    }
+    for (int i = 0; i < IMU_DROP_SOURCE_COUNT; i++) {
+        printf("TRACE DROP %d %s\n", i, imu_drop_source_name((imu_drop_source_t)i));
+    }
+    for (uint32_t i = head - count; i != head; i++) {
+        const trace_event_t *event = &g_trace_ring[i & (TRACE_EVENTS - 1)];
+        printf("TRACE E %08" PRIx32 " %u %u\n", event->time, (unsigned)event->type, (unsigned)event->arg);
+    }
+    printf("TRACE END\n");
+    serial_unlock();
+
+    g_trace_head.store(0, std::memory_order_relaxed);
+    g_trace_enabled.store(true, std::memory_order_relaxed);
+}
+
+// RTX only calls EvrRtxThreadSwitched when its thread events are compiled in
+// (OS_EVR_THREAD set and EVR_RTX_DISABLE not defined); otherwise the override
+// above is never called. By the first report the system has switched threads
+// many times, so an empty thread table means the hook is missing.
+static void trace_check_hook() {
+    if (trace_hook_checked) {
+        return;
+    }
+    trace_hook_checked = true;
+    if (trace_thread_count.load(std::memory_order_acquire) == 0) {
+        LOG_WARN("Trace: no thread switches recorded, RTX thread events are compiled out; "
+                 "events will all be on the 'unknown' track");
+    }
+}
+
+void trace_poll_command() {
+    trace_check_hook();
+
+    bool requested = false;
+    char c;
+    while (serial_read_char(&c)) {
+        if (c == TRACE_DUMP_COMMAND) {
+            requested = true;
+        }
+    }
+    if (requested) {
+        trace_dump();
+    }
+}
+
+#endif // TRACE_BUFFER